@@ -0,0 +1,55 @@
+#include "attr.h"
+#include "vram_queue.h"
+
+#pragma static-locals (on)
+
+// --- Attribute Table Shadow (see attr.h) ---
+// Tile (x, y) is in byte (y / 4) * 8 + x / 4. Within a byte the quadrants are, from
+// bit 0 up: top left, top right, bottom left, bottom right, so the shift is
+// (y & 2) * 2 + (x & 2).
+unsigned char attr_shadow[ATTR_BYTES];
+static unsigned char attr_dirty[8];   // Per attribute row, one bit per dirty column
+static unsigned char attr_dirty_rows; // One bit per row with a non-zero attr_dirty entry
+
+static const unsigned char attr_bit[8] = { 0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80 };
+static const unsigned char attr_quadrant_mask[8] = { 0x03, 0, 0x0C, 0, 0x30, 0, 0xC0, 0 }; // By shift
+static const unsigned char attr_fill[4] = { 0x00, 0x55, 0xAA, 0xFF }; // pal in all four quadrants
+
+void attr_init(unsigned char value) {
+    unsigned char i;
+    for (i = 0; i < ATTR_BYTES; ++i) attr_shadow[i] = value;
+    for (i = 0; i < 8; ++i) attr_dirty[i] = 0;
+    attr_dirty_rows = 0;
+}
+
+void attr_set(unsigned char x_tile, unsigned char y_tile, unsigned char pal) {
+    unsigned char row = y_tile >> 2, col = x_tile >> 2, i = (y_tile & 0xFC) * 2 + col;
+    unsigned char mask = attr_quadrant_mask[((y_tile & 2) << 1) | (x_tile & 2)];
+    unsigned char v = (attr_shadow[i] & ~mask) | (attr_fill[pal & 3] & mask);
+    if (v == attr_shadow[i]) return;
+    attr_shadow[i] = v;
+    attr_dirty[row] |= attr_bit[col];
+    attr_dirty_rows |= attr_bit[row];
+}
+
+void attr_set_rect(unsigned char x_tile, unsigned char y_tile, unsigned char w, unsigned char h, unsigned char pal) {
+    unsigned char x, y, x_end = x_tile + w, y_end = y_tile + h;
+    // One attr_set() per quadrant: 2 tiles at a time from the quadrant holding the first tile.
+    for (y = y_tile & 0xFE; y < y_end; y += 2) {
+        for (x = x_tile & 0xFE; x < x_end; x += 2) attr_set(x, y, pal);
+    }
+}
+
+void attr_flush(void) {
+    unsigned char row, bits, first, last;
+    if (attr_dirty_rows == 0) return;
+    for (row = 0; row < 8; ++row) {
+        bits = attr_dirty[row];
+        if (bits == 0) continue;
+        for (first = 0; !(bits & attr_bit[first]); ++first) {}
+        for (last = 7; !(bits & attr_bit[last]); --last) {}
+        if (!vram_queue_put(ATTR_ADDR + row * 8 + first, attr_shadow + row * 8 + first, last - first + 1)) return;
+        attr_dirty[row] = 0;
+        attr_dirty_rows &= ~attr_bit[row];
+    }
+}
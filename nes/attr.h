@@ -0,0 +1,32 @@
+#ifndef ATTR_H
+#define ATTR_H
+
+// --- Attribute Table Shadow ---
+// A RAM copy of nametable A's 64 attribute bytes. Palettes are set per 16x16-pixel
+// quadrant (2x2 tiles, 2 bits of an attribute byte) in the shadow, so neighbouring
+// quadrants keep their palettes and the PPU is never read back. Changed bytes are
+// marked dirty and attr_flush() queues them for the NMI (vram_queue.h), one run per
+// attribute row, spanning its first to last dirty byte.
+// The shadow only sees writes made through it. A program that also writes attribute
+// bytes itself (survivor_v3's streamed playfield, rows 1-7) must keep attr_set*() off
+// those rows, or a flush puts stale neighbouring quadrants back over its data.
+#define ATTR_ADDR  0x23C0 // Nametable A's attribute table
+#define ATTR_BYTES 64     // 8 x 8 bytes, each covering 4x4 tiles
+
+extern unsigned char attr_shadow[ATTR_BYTES];
+
+// Sets every byte of the shadow to value without marking anything dirty: call it with
+// whatever setup wrote to the attribute table (vram_fill()).
+void attr_init(unsigned char value);
+
+// Gives the quadrant holding tile (x_tile, y_tile) palette pal (0..3).
+void attr_set(unsigned char x_tile, unsigned char y_tile, unsigned char pal);
+
+// Gives every quadrant overlapping the w x h tile rectangle at (x_tile, y_tile) palette pal.
+void attr_set_rect(unsigned char x_tile, unsigned char y_tile, unsigned char w, unsigned char h, unsigned char pal);
+
+// Queues the dirty bytes for the next vblank(s). Rows that don't fit in the queue stay
+// dirty for the next call. Cheap when nothing changed; call it once a frame.
+void attr_flush(void);
+
+#endif
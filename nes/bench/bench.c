@@ -0,0 +1,96 @@
+// bench.c - times survivor_v3's hot routines under cc65's sim65 (see run_bench.sh).
+//
+// Built with -t sim6502 -DSURVIVOR_NO_MAIN, it pulls in survivor_v3.c unchanged minus
+// main(). sim65 has flat RAM, so the PPU/APU/JOYPAD registers are plain memory; none of
+// the kernels below touch them (input and VRAM writes are left out), and the OAM pages
+// are moved to $C000/$C100 by the Makefile, well above the program.
+//
+//   sim65 -c bench.prg KERNEL ENEMIES ITERATIONS
+//
+// rebuilds the ENEMIES scenario and runs KERNEL once, ITERATIONS times. Kernel "none"
+// only rebuilds the scenario, so (cycles(KERNEL) - cycles(none)) / ITERATIONS is the
+// exact cost of one call: the simulator is deterministic.
+
+#include <stdlib.h>
+#include <string.h>
+#include "survivor_v3.c"
+
+static unsigned char bench_enemies;
+
+// Enemies on a 30-pixel lattice above the player, projectiles in a row below them
+// heading up through it. Nothing overlaps the player, so no hit lands this frame. All
+// enemies are ENEMY_HOMING, so readings compare with runs from before enemy types.
+// The song restarts and three effects start, so the next sound_update() starts a note
+// on every channel and an effect on three: its worst case short of an order list loop.
+static void scenario(void) {
+    unsigned char i, s;
+    entity_lists_init();
+    player_x = 124; player_y = 200; player_health = PLAYER_MAX_HEALTH; player_hit_timer = 0;
+    frame_count = 0; mux_start = 0; lag_set_level(0); rand_seed = SPAWN_SEED;
+    sound_music(song_main); sound_sfx(sfx_shot); sound_sfx(sfx_kill); sound_sfx(sfx_hit);
+    for (i = 0; i < bench_enemies; ++i) {
+        s = enemy_alloc();
+        enemy_x[s] = 12 + (i & 7) * 30; enemy_y[s] = 20 + (i >> 3) * 30;
+        enemy_type[s] = ENEMY_HOMING; enemy_dx[s] = enemy_dy[s] = 0; enemy_phase[s] = 0;
+        grid_insert(s);
+    }
+    for (i = 0; i < MAX_PROJECTILES; ++i) {
+        s = projectile_alloc();
+        projectile_x[s] = 8 + i * 20; projectile_y[s] = 190;
+    }
+    oam_back_page = OAM_PAGE_A; oam_buffer = OAM_PAGE_PTR(OAM_PAGE_A);
+    oam_prev_end[0] = oam_prev_end[1] = PLAYER_OAM_OFFSET;
+}
+
+static void k_none(void) {}
+static void k_rand8(void) { rand8(); }
+static void k_score_add(void) { add_score(0x01); }             // Score keeps counting across iterations
+static void k_score_tiles(void) { score_changed = SCORE_DIGITS; update_score_display(); vram_queue_head = vram_queue_tail; }
+static void k_collide(void) {                                  // One narrow-phase test
+    box_x = player_x; box_y = player_y; box_w = PLAYER_SPRITE_WIDTH; box_h = PLAYER_SPRITE_HEIGHT;
+    enemy_slot = 0; collide_box_enemy();
+}
+static void k_grid_find_hit(void) {                            // One broad-phase query at the lattice centre
+    box_x = 112; box_y = 80; box_w = PROJECTILE_SPRITE_WIDTH; box_h = PROJECTILE_SPRITE_HEIGHT;
+    grid_find_hit();
+}
+static void k_spawn_enemy(void) { spawn_enemy(); }
+static void k_projectiles(void) { update_projectiles(); }
+static void k_enemies(void) { update_enemies(); }
+static void k_oam(void) { build_oam(); }
+static void k_oam_clear(void) { memset(oam_buffer, HIDE_SPRITE_Y, 256); } // The per-frame clear oam_finish() replaced
+static void k_sound(void) { sound_update(); }
+static void k_frame(void) { update_projectiles(); update_enemies(); build_oam(); }
+
+static const struct { const char* name; void (*run)(void); } kernels[] = {
+    { "none", k_none },
+    { "rand8", k_rand8 },
+    { "score_add", k_score_add },
+    { "score_tiles", k_score_tiles },
+    { "collide", k_collide },
+    { "grid_find_hit", k_grid_find_hit },
+    { "spawn_enemy", k_spawn_enemy },
+    { "projectiles", k_projectiles },
+    { "enemies", k_enemies },
+    { "oam", k_oam },
+    { "oam_clear", k_oam_clear },
+    { "sound", k_sound },
+    { "frame", k_frame },
+};
+
+int main(int argc, char** argv) {
+    unsigned char k;
+    unsigned int n;
+    void (*run)(void) = 0;
+    if (argc != 4) return 2;
+    for (k = 0; k < sizeof(kernels) / sizeof(kernels[0]); ++k) {
+        if (strcmp(argv[1], kernels[k].name) == 0) run = kernels[k].run;
+    }
+    if (run == 0) return 1;
+    bench_enemies = atoi(argv[2]);
+    if (bench_enemies > MAX_ENEMIES) return 1;
+    memset(OAM_PAGE_PTR(OAM_PAGE_A), HIDE_SPRITE_Y, 512);
+    score_reset(); score_changed = 0;
+    for (n = atoi(argv[3]); n != 0; --n) { scenario(); run(); }
+    return 0;
+}
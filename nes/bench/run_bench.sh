@@ -0,0 +1,30 @@
+#!/bin/sh
+# run_bench.sh SIM65 BENCH_PRG [ITERATIONS]
+# Runs every bench.c kernel for each scenario and prints CSV on stdout:
+#   kernel,enemies,cycles_per_call,scanlines
+# Cycles are exact (sim65 is deterministic), so diff the output between changes to spot
+# regressions. A scanline is 113.67 CPU cycles (NTSC); a frame is 262 of them, about 20
+# of which are vblank. In survivor_v3 the NMI then waits for the status bar split, down
+# to the bottom of the bar (HUD_ROWS * 8 = 32 more lines), so all of game_frame(),
+# "frame" included, has about 210 lines before the game lags.
+sim=$1
+prg=$2
+iters=${3:-64}
+kernels="rand8 score_add score_tiles collide grid_find_hit spawn_enemy projectiles enemies oam oam_clear sound frame"
+
+cycles() { # KERNEL ENEMIES -> total cycles reported by sim65 -c
+    "$sim" -c "$prg" "$1" "$2" "$iters" 2>&1 | awk '{ for (i = 2; i <= NF; i++) if ($i == "cycles") n = $(i - 1) } END { print n }'
+}
+
+echo "kernel,enemies,cycles_per_call,scanlines"
+for enemies in 0 10 30 48 64; do
+    base=$(cycles none "$enemies")
+    for k in $kernels; do
+        total=$(cycles "$k" "$enemies")
+        if [ -z "$total" ] || [ -z "$base" ]; then
+            echo "run_bench.sh: $k/$enemies failed" >&2; exit 1
+        fi
+        awk -v k="$k" -v e="$enemies" -v t="$total" -v b="$base" -v n="$iters" \
+            'BEGIN { c = (t - b) / n; printf "%s,%d,%.1f,%.2f\n", k, e, c, c / 113.67 }'
+    done
+done
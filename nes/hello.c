@@ -1,5 +1,10 @@
 #include <nes.h>
 #include <string.h> // For memset
+#include "vram_queue.h"
+#include "vram.h"
+#include "attr.h"
+#include "text.h"
+#include "input.h"
 
 // --- Constants ---
 // PPU VRAM Addresses
@@ -31,17 +36,7 @@ unsigned char sprite_x;
 unsigned char sprite_y;
 
 // --- PPU Helper Functions ---
-
-// Set PPU VRAM Address
-void ppu_set_address(unsigned int addr) {
-    PPU.vram.address = (unsigned char)(addr >> 8);
-    PPU.vram.address = (unsigned char)(addr & 0xFF);
-}
-
-// Write to PPU VRAM Data
-void ppu_write_data(unsigned char data) {
-    PPU.vram.data = data;
-}
+// Bulk VRAM writes (palette, nametable, text) go through vram.s.
 
 // Trigger OAM DMA transfer from OAM_ADDRESS ($0200)
 void trigger_oam_dma(void) {
@@ -50,29 +45,6 @@ void trigger_oam_dma(void) {
     // This halts the CPU for ~513 cycles
 }
 
-// --- Input Reading ---
-unsigned char read_joypad1(void) {
-    unsigned char status = 0;
-    unsigned char i;
-
-    // Strobe the controller to latch current button states
-    JOYPAD[0] = 1;
-    // Small delay might be needed between strobe writes on some hardware/emulators
-    // for (i=0; i<10; ++i); // Optional small delay
-    JOYPAD[0] = 0;
-
-    // Read the 8 button states sequentially
-    // Order: A, B, Select, Start, Up, Down, Left, Right
-    for (i = 0; i < 8; ++i) {
-        status >>= 1; // Shift previous bits
-        if (JOYPAD[0] & 1) { // Read the lowest bit
-             status |= 0x80; // Set the top bit if button is pressed
-        }
-    }
-    // Returns raw bits: R L D U T S B A (Right is MSB, A is LSB)
-    return status;
-}
-
 // --- Main Program ---
 
 // Define our palettes (Background + Sprite)
@@ -95,32 +67,14 @@ const unsigned char palette[32] = {
 // Define the text from the first example (Optional, can be removed if only moving sprite)
 #define TEXT_X 10
 #define TEXT_Y 12
-#define TEXT_STR "HELLO NES!"
+// The string itself is text_hello in text.s, already in tile indices
 #define TEXT_PALETTE_IDX 1 // Use Background Palette 1 for text
 
-// Function to set attribute byte (needed if displaying text)
-void set_attribute_byte(unsigned int addr, unsigned char value) {
-    waitvsync();
-    ppu_set_address(addr);
-    ppu_write_data(value);
-}
-
-// Function to set tile palette (needed if displaying text)
-void set_tile_palette(unsigned char x, unsigned char y, unsigned char pal_idx) {
-    unsigned int attr_addr;
-    unsigned char attr_byte;
-    unsigned char shift_val;
-    attr_addr = ATTRIBUTE_A + ((y / 4) * 8) + (x / 4);
-    if ((y % 4) < 2) { shift_val = ((x % 4) < 2) ? 0 : 2; }
-    else             { shift_val = ((x % 4) < 2) ? 4 : 6; }
-    // Simplified: Assume attribute byte is 0 initially or we overwrite
-    attr_byte = (pal_idx & 0x03) << shift_val;
-    set_attribute_byte(attr_addr, attr_byte);
-}
+// Text palettes are set per 2x2-tile quadrant in the attribute shadow (attr.c), which
+// queues the changed bytes for the NMI.
 
 
 int main(void) {
-    unsigned char i;
     unsigned char joy_status;
     unsigned int vram_addr; // Needed for text display
 
@@ -128,51 +82,24 @@ int main(void) {
 
     // 1. Turn off screen during setup
     waitvsync();
-    PPU.control = 0x80; // NMI Enabled, Sprites $0000, BG $0000, 8x8 Sprites, VRAM Inc +1
-                        // Sprite pattern table at $0000 (bit 3 = 0)
-                        // Change to 0x88 if sprites are at $1000
+    PPU.control = 0x00; // NMI Disabled until setup is done: the NMI moves the PPU address
     PPU.mask = 0x00;    // Screen OFF
 
     // 2. Load Palettes (Background and Sprite)
-    ppu_set_address(PALETTE_RAM);
-    for (i = 0; i < 32; ++i) {
-        ppu_write_data(palette[i]);
-    }
+    vram_copy(PALETTE_RAM, palette, sizeof(palette));
 
-    // 3. Clear Name Table (fill with tile 0x20 - space, for text visibility)
-    ppu_set_address(NAMETABLE_A);
-    for (vram_addr = 0; vram_addr < 960; ++vram_addr) {
-         ppu_write_data(0x20); // Assuming tile $20 is a blank space
-    }
+    // 3. Clear Name Table (fill with the blank tile that text.s also uses for spaces)
+    vram_fill(NAMETABLE_A, TEXT_TILE_BLANK, 960);
     // Clear Attribute Table (set all to palette 0)
-    ppu_set_address(ATTRIBUTE_A);
-     for (i = 0; i < 64; ++i) {
-        ppu_write_data(0x00); // All areas use palette 0 initially
-    }
+    vram_fill(ATTRIBUTE_A, 0x00, 64);
+    attr_init(0x00);
 
     // --- Display HELLO NES Text (from first example) ---
     vram_addr = NAMETABLE_A + (TEXT_Y * 32) + TEXT_X;
-    waitvsync();
-    ppu_set_address(vram_addr);
-    { // Use block scope for ptr and len
-        const char* ptr = TEXT_STR;
-        unsigned char len = strlen(ptr);
-        for (i = 0; i < len; ++i) {
-            unsigned char tile_index;
-            if (ptr[i] >= 'A' && ptr[i] <= 'Z') tile_index = ptr[i] - 'A' + 0x41;
-            else if (ptr[i] >= 'a' && ptr[i] <= 'z') tile_index = ptr[i] - 'a' + 0x41;
-            else if (ptr[i] >= '0' && ptr[i] <= '9') tile_index = ptr[i] - '0' + 0x30;
-            else if (ptr[i] == ' ') tile_index = 0x20;
-            else if (ptr[i] == '!') tile_index = 0x21;
-            else tile_index = 0x20;
-            ppu_write_data(tile_index);
-        }
-        // Set attribute bits for the text
-        for(i = 0; i < len; ++i) {
-            // Call for each tile; function handles attribute byte granularity
-             set_tile_palette(TEXT_X + i, TEXT_Y, TEXT_PALETTE_IDX);
-        }
-    }
+    text_draw(vram_addr, text_hello); // One bulk copy, no per-character mapping
+    // Set attribute bits for the text (only its quadrants; drained once the NMI is on)
+    attr_set_rect(TEXT_X, TEXT_Y, TEXT_LEN(text_hello), 1, TEXT_PALETTE_IDX);
+    attr_flush();
     // --- End Text Display ---
 
 
@@ -202,6 +129,9 @@ int main(void) {
     PPU.scroll = 0x00; // Reset scroll registers
     PPU.scroll = 0x00;
     PPU.mask = 0x1E;   // Screen ON: Show Background, Show Sprites, Show edges
+    PPU.control = 0x80; // NMI Enabled, Sprites $0000, BG $0000, 8x8 Sprites, VRAM Inc +1
+                        // Sprite pattern table at $0000 (bit 3 = 0)
+                        // Change to 0x88 if sprites are at $1000
 
     // --- Main Game Loop ---
     while (1) {
@@ -218,10 +148,10 @@ int main(void) {
         trigger_oam_dma();
 
         // --- Read Input ---
-        joy_status = read_joypad1(); // Raw bits: R L D U T S B A
+        input_update(); joy_status = pad_held[0]; // Bits: R L D U T S B A (input.s)
 
         // --- Update Logic ---
-        // Check D-Pad bits (remembering the order from read_joypad1: R L D U ...)
+        // Check D-Pad bits (remembering the order from input.s: R L D U ...)
         // Bit 4: Up (0x10)
         if ((joy_status & 0x10) && sprite_y > MIN_Y) {
             sprite_y--;
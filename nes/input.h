@@ -0,0 +1,17 @@
+#ifndef INPUT_H
+#define INPUT_H
+
+// --- Input (input.s) ---
+// Index 0 is controller 1, index 1 controller 2. Bits follow JOY_*_MASK from nes.h.
+// Zero page isn't cleared at startup, so clear pad_held before the first input_update()
+// if that frame's pressed/released edges matter.
+extern unsigned char pad_held[2];     // Buttons down this frame
+extern unsigned char pad_pressed[2];  // Went down since the last input_update()
+extern unsigned char pad_released[2]; // Went up since the last input_update()
+#pragma zpsym ("pad_held")
+#pragma zpsym ("pad_pressed")
+#pragma zpsym ("pad_released")
+
+void input_update(void); // Reads both pads (DPCM-safe) and updates the masks
+
+#endif
@@ -0,0 +1,81 @@
+;
+; input.s - controller driver for both joypads.
+;
+; input_update() latches both controllers once and reads them in a single
+; unrolled pass, then leaves held/pressed/released masks in zero page for the
+; frame's logic. Bits match nes.h's JOY_*_MASK: A is bit 0, Right is bit 7.
+; A DPCM sample fetch during a $4016/$4017 read can clock an extra bit out and
+; corrupt it, so the pads are read again until two passes agree.
+;
+
+        .exportzp       _pad_held, _pad_pressed, _pad_released
+        .export         _input_update
+
+JOYPAD1 = $4016
+JOYPAD2 = $4017
+
+.segment        "ZEROPAGE"
+
+_pad_held:      .res    2               ; Buttons down this frame, per pad
+_pad_pressed:   .res    2               ; Went down since the last update
+_pad_released:  .res    2               ; Went up since the last update
+buf:            .res    2               ; Pass being read
+
+.segment        "BSS"
+
+first:          .res    2               ; Previous pass, for the stability check
+
+.segment        "CODE"
+
+; ------------------------------------------------------------------------
+; Strobe and read 8 bits from each pad into buf/buf+1, A first. Bit 1 is
+; merged with bit 0 so Famicom expansion-port pads work too. 8 x 26 cycles.
+
+read_pads:
+        lda     #1
+        sta     JOYPAD1
+        lsr                             ; A = 0
+        sta     JOYPAD1
+        .repeat 8
+        lda     JOYPAD1
+        and     #%00000011
+        cmp     #1                      ; C = either data bit set
+        ror     buf
+        lda     JOYPAD2
+        and     #%00000011
+        cmp     #1
+        ror     buf+1
+        .endrepeat
+        rts
+
+; ------------------------------------------------------------------------
+; void input_update(void) - call once per frame, before the game logic.
+
+_input_update:
+        jsr     read_pads
+@again: lda     buf
+        sta     first
+        lda     buf+1
+        sta     first+1
+        jsr     read_pads
+        lda     buf
+        cmp     first
+        bne     @again                  ; A pass was corrupted: read until stable
+        lda     buf+1
+        cmp     first+1
+        bne     @again
+
+        ldx     #1
+@edges: lda     _pad_held,x             ; Last frame's buttons
+        eor     buf,x
+        tay                             ; Y = changed bits
+        and     buf,x
+        sta     _pad_pressed,x          ; Changed and down now
+        tya
+        and     _pad_held,x
+        sta     _pad_released,x         ; Changed and down before
+        lda     buf,x
+        sta     _pad_held,x
+        dex
+        bpl     @edges
+        rts
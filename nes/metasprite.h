@@ -0,0 +1,25 @@
+#ifndef METASPRITE_H
+#define METASPRITE_H
+
+// --- Metasprites (metasprite.s) ---
+// A character bigger than one tile is a ROM template: a flip span byte (width - 8) and
+// then one 4-byte piece per tile, ended by META_END:
+//   dy, tile, attr, dx    offsets 0..127 from the character's top-left corner
+// oam_meta() writes the pieces into the game's OAM writer state (oam_buffer at oam_idx)
+// from one unrolled loop, instead of a C OAM_PUT_SPRITE per tile. Pieces that would wrap
+// past the right edge or reach the hidden lines are dropped, and it stops once the page
+// is full, leaving oam_idx at 0 (OAM_FULL). Check OAM_FULL() before calling, as for a
+// single sprite. oam_meta_flip() mirrors the character within its width: each piece's
+// dx becomes span - dx and its attribute gets META_HFLIP.
+#define META_END               0x80 // dy value that ends a template
+#define META_HFLIP             0x40 // OAM attribute bit: tile mirrored horizontally
+
+extern unsigned char* oam_buffer; // Back OAM page (page aligned), defined by the game
+extern unsigned char oam_idx;     // Next OAM byte to fill
+#pragma zpsym ("oam_buffer")
+#pragma zpsym ("oam_idx")
+
+void oam_meta(unsigned char x, unsigned char y, const unsigned char* data);
+void oam_meta_flip(unsigned char x, unsigned char y, const unsigned char* data);
+
+#endif
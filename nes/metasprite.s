@@ -0,0 +1,96 @@
+;
+; metasprite.s - draws multi-tile characters from ROM templates (see metasprite.h).
+;
+; Template and OAM page are both walked through pointers advanced 4 bytes a piece, so
+; each piece is a straight run of (ptr),y loads and stores with constant Y. The OAM page
+; is page aligned, so the low byte of ptr2 is oam_idx itself and wraps to 0 when full.
+; Roughly 120 cycles a piece; the argument handling is paid once per character.
+;
+
+        .include        "zeropage.inc"
+        .import         popa
+        .importzp       _oam_buffer, _oam_idx
+        .export         _oam_meta, _oam_meta_flip
+
+META_END          = $80                 ; Keep in sync with metasprite.h
+META_HFLIP        = $40
+OAM_Y_LIMIT       = $EF                 ; OAM Y of the first hidden line (HIDE_SPRITE_Y - 1)
+
+.segment        "CODE"
+
+; ------------------------------------------------------------------------
+; void oam_meta(unsigned char x, unsigned char y, const unsigned char* data)
+; void oam_meta_flip(unsigned char x, unsigned char y, const unsigned char* data)
+
+_oam_meta:
+        ldy     #0
+        beq     draw                    ; Always taken
+_oam_meta_flip:
+        ldy     #META_HFLIP
+draw:   sty     tmp3                    ; Attribute flip bits; bit 6 also selects the mirror
+        sta     ptr1
+        stx     ptr1+1
+        jsr     popa
+        sec
+        sbc     #1                      ; OAM Y is one line above the sprite
+        sta     tmp2
+        jsr     popa
+        sta     tmp1                    ; x
+        ldy     #0
+        lda     (ptr1),y
+        sta     tmp4                    ; Flip span
+        inc     ptr1                    ; First piece
+        bne     @ptr
+        inc     ptr1+1
+@ptr:   lda     _oam_idx
+        sta     ptr2
+        lda     _oam_buffer+1
+        sta     ptr2+1
+
+@piece: ldy     #0
+        lda     (ptr1),y                ; dy
+        cmp     #META_END
+        beq     @done
+        clc
+        adc     tmp2
+        bcs     @next                   ; Wrapped off the bottom
+        cmp     #OAM_Y_LIMIT
+        bcs     @next                   ; On the hidden lines
+        tax                             ; Held until x is known to be on screen
+        ldy     #3
+        lda     (ptr1),y                ; dx
+        bit     tmp3
+        bvc     @right
+        eor     #$FF                    ; span - dx
+        sec
+        adc     tmp4
+@right: clc
+        adc     tmp1
+        bcs     @next                   ; Past the right edge
+        sta     (ptr2),y
+        dey
+        lda     (ptr1),y                ; attr
+        eor     tmp3
+        sta     (ptr2),y
+        dey
+        lda     (ptr1),y                ; tile
+        sta     (ptr2),y
+        dey
+        txa
+        sta     (ptr2),y
+        lda     ptr2
+        clc
+        adc     #4
+        sta     ptr2
+        beq     @done                   ; Page full
+@next:  lda     ptr1
+        clc
+        adc     #4
+        sta     ptr1
+        bcc     @piece
+        inc     ptr1+1
+        bcs     @piece                  ; Always taken (C still set)
+
+@done:  lda     ptr2
+        sta     _oam_idx
+        rts
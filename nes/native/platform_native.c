@@ -0,0 +1,172 @@
+#include <string.h>
+#include "platform.h"
+#include "platform_native.h"
+#include "nmi.h"
+#include "vram_queue.h"
+#include "input.h"
+#include "rand.h"
+#include "text.h"
+#include "metasprite.h"
+#include "split.h"
+#include "sound.h"
+
+// --- Native Stub Backend (see platform.h) ---
+// Replaces the PPU registers and the asm modules (nmi.s, input.s, rand.s, vram.s, text.s,
+// metasprite.s, split.s) with plain C that behaves the same way, so survivor_v3.c runs
+// headless on the host. Sound (sound.s, sound_data.s) is left out: it only writes the APU.
+
+unsigned char native_vram[0x4000];
+unsigned char native_oam[256];
+unsigned long native_vram_writes;
+unsigned long native_oam_dmas;
+unsigned char native_pad_input[2];
+unsigned char native_ppu_mask;
+unsigned int native_split_x;
+unsigned long native_split_misses;
+unsigned long native_sfx_count;
+
+unsigned char native_oam_ram[512];
+static unsigned int vram_addr;
+static unsigned char oam_shown;
+
+// nmi.s
+unsigned char vram_queue[256];
+unsigned char vram_queue_head;
+volatile unsigned char vram_queue_tail;
+volatile unsigned char nmi_frame;
+volatile unsigned char oam_ready;
+
+// input.s
+unsigned char pad_held[2], pad_pressed[2], pad_released[2];
+
+// rand.s
+unsigned int rand_seed;
+
+// vram.s
+unsigned char vram_ctrl;
+
+// text.s (tile indices: ASCII letters, space = TEXT_TILE_BLANK)
+const unsigned char text_score[] = { 6, 'S', 'C', 'O', 'R', 'E', TEXT_TILE_BLANK };
+const unsigned char text_hello[] = { 10, 'H', 'E', 'L', 'L', 'O', TEXT_TILE_BLANK, 'N', 'E', 'S', '!' };
+
+void native_reset(void) {
+    memset(native_vram, 0, sizeof(native_vram));
+    memset(native_oam, 0, sizeof(native_oam));
+    native_vram_writes = native_oam_dmas = 0;
+    native_pad_input[0] = native_pad_input[1] = 0;
+    native_ppu_mask = 0; native_split_x = 0; native_split_misses = 0; native_sfx_count = 0;
+    vram_addr = 0; oam_shown = 0; vram_ctrl = 0;
+    vram_queue_head = vram_queue_tail = 0; split_on = 0;
+    nmi_frame = 0; oam_ready = 0;
+}
+
+// --- PPU Registers ---
+void ppu_ctrl(unsigned char v) { vram_ctrl = v; }
+void ppu_mask(unsigned char v) { native_ppu_mask = v; }
+void ppu_scroll(unsigned char x, unsigned char y) { (void)x; (void)y; }
+void ppu_addr(unsigned int a) { vram_addr = a & 0x3FFF; }
+void ppu_data(unsigned char v) { // Increment from PPU.control bit 2 (vram_copy_stride32)
+    native_vram[vram_addr] = v; vram_addr = (vram_addr + ((vram_ctrl & 0x04) ? 32 : 1)) & 0x3FFF;
+    ++native_vram_writes;
+}
+
+void platform_waitvsync(void) { }
+
+// --- Emulated NMI (nmi.s: OAM DMA, frame counter, VRAM queue drain incl. column runs;
+// split.s: no raster to wait for, so it records the scroll, or a split that would time
+// out because sprite 0 isn't on screen) ---
+void platform_idle(void) {
+    unsigned char x, len, budget = VRAM_QUEUE_BUDGET, ctrl = vram_ctrl;
+    if (oam_ready) { oam_shown = oam_ready; oam_ready = 0; }
+    if (oam_shown) { memcpy(native_oam, OAM_PAGE_PTR(oam_shown), 256); ++native_oam_dmas; }
+    ++nmi_frame;
+    x = vram_queue_tail;
+    while (x != vram_queue_head) {
+        len = vram_queue[x];
+        if (len > budget) break; // Waits for the next vblank
+        budget -= len;
+        vram_ctrl = (vram_queue[(unsigned char)(x + 1)] & (VRAM_QUEUE_COLUMN >> 8)) ? ctrl | 0x04 : ctrl;
+        ppu_addr((vram_queue[(unsigned char)(x + 1)] << 8) | vram_queue[(unsigned char)(x + 2)]);
+        x += 3;
+        while (len--) ppu_data(vram_queue[x++]);
+    }
+    vram_ctrl = ctrl;
+    vram_queue_tail = x;
+    if (!split_on) return;
+    if (oam_shown == 0 || native_oam[0] >= 0xEF) ++native_split_misses;
+    else native_split_x = split_x[oam_shown & 1] & 0x1FF;
+}
+
+// --- input.s ---
+void input_update(void) {
+    unsigned char i, now;
+    for (i = 0; i < 2; ++i) {
+        now = native_pad_input[i];
+        pad_pressed[i] = (pad_held[i] ^ now) & now;
+        pad_released[i] = (pad_held[i] ^ now) & pad_held[i];
+        pad_held[i] = now;
+    }
+}
+
+// --- rand.s (same 16-bit xorshift, so a seed gives the same spawns as on the NES) ---
+unsigned char rand8(void) {
+    unsigned int x = rand_seed & 0xFFFF;
+    x ^= (x << 7) & 0xFFFF;
+    x ^= x >> 9;
+    x ^= (x << 8) & 0xFFFF;
+    rand_seed = x;
+    return (unsigned char)(x >> 8);
+}
+
+// --- vram.s ---
+void vram_fill(unsigned int addr, unsigned char value, unsigned int len) {
+    ppu_addr(addr);
+    while (len--) ppu_data(value);
+}
+void vram_copy(unsigned int addr, const unsigned char* src, unsigned int len) {
+    ppu_addr(addr);
+    while (len--) ppu_data(*src++);
+}
+void vram_copy_stride32(unsigned int addr, const unsigned char* src, unsigned char len) {
+    unsigned char ctrl = vram_ctrl;
+    vram_ctrl = ctrl | 0x04; ppu_addr(addr);
+    while (len--) ppu_data(*src++);
+    vram_ctrl = ctrl;
+}
+void vram_unrle(unsigned int addr, const unsigned char* src) {
+    unsigned char n;
+    ppu_addr(addr);
+    while ((n = *src++) != 0) {
+        if (n & 0x80) { for (n &= 0x7F; n; --n) ppu_data(*src); ++src; }
+        else while (n--) ppu_data(*src++);
+    }
+}
+
+// split.s's state; the split itself is part of the emulated NMI above
+unsigned int split_x[2];
+unsigned char split_on;
+
+// sound.s and sound_data.s (silent: effect requests are only counted)
+const unsigned char song_main[1], sfx_shot[1], sfx_kill[1], sfx_hit[1];
+void sound_init(void) { }
+void sound_music(const unsigned char* song) { (void)song; }
+void sound_sfx(const unsigned char* sfx) { (void)sfx; ++native_sfx_count; }
+void sound_update(void) { }
+
+// metasprite.s
+static void meta_draw(unsigned char x, unsigned char y, const unsigned char* data, unsigned char flip) {
+    unsigned char span = *data++, oy, ox;
+    for (; data[0] != META_END; data += 4) {
+        if (data[0] + (unsigned char)(y - 1) > 0xFF) continue; // Wrapped off the bottom
+        oy = data[0] + (unsigned char)(y - 1);
+        if (oy >= 0xEF) continue; // On the hidden lines (HIDE_SPRITE_Y - 1)
+        ox = flip ? (unsigned char)(span - data[3]) : data[3];
+        if (ox + x > 0xFF) continue; // Past the right edge
+        ox += x;
+        oam_buffer[oam_idx + 0] = oy; oam_buffer[oam_idx + 1] = data[1];
+        oam_buffer[oam_idx + 2] = data[2] ^ flip; oam_buffer[oam_idx + 3] = ox;
+        if ((oam_idx += 4) == 0) return; // Page full
+    }
+}
+void oam_meta(unsigned char x, unsigned char y, const unsigned char* data) { meta_draw(x, y, data, 0); }
+void oam_meta_flip(unsigned char x, unsigned char y, const unsigned char* data) { meta_draw(x, y, data, META_HFLIP); }
@@ -0,0 +1,18 @@
+#ifndef PLATFORM_NATIVE_H
+#define PLATFORM_NATIVE_H
+
+// --- Native Backend State (platform_native.c) ---
+// What the stub backend recorded, for the driver to check and hash.
+extern unsigned char native_vram[0x4000];      // PPU address space as written ($2000+ nametables, $3F00 palette)
+extern unsigned char native_oam[256];          // OAM as last DMA'd by the emulated NMI
+extern unsigned long native_vram_writes;       // $2007 writes, direct and from the VRAM queue
+extern unsigned long native_oam_dmas;          // Emulated OAM DMAs
+extern unsigned char native_pad_input[2];      // Buttons the next input_update() reads
+extern unsigned char native_ppu_mask;          // Last PPU.mask write
+extern unsigned int native_split_x;            // Scroll of the last split (0..511)
+extern unsigned long native_split_misses;      // Splits with no sprite 0 on screen
+extern unsigned long native_sfx_count;         // sound_sfx() calls
+
+void native_reset(void); // Power-on state for a new run
+
+#endif
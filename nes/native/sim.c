@@ -0,0 +1,223 @@
+// sim.c - headless native build of survivor_v3 for fuzzing and tuning (make sim).
+//
+//   survivor_sim [-f FRAMES] [-r RUNS] [-s SEED] [-g] [-l] [-p] [-v]
+//
+// Built with -DNATIVE -DSURVIVOR_NO_MAIN, it pulls in survivor_v3.c unchanged and runs it
+// on the stub backend in platform_native.c. Each run resets the backend, calls
+// game_init(), reseeds the spawn PRNG from the run seed and then feeds up to FRAMES frames
+// of random pad input through game_frame(), checking the game's invariants after every
+// frame. Game over (health 0, where main() leaves for its screen) ends a run early; -g
+// refills the player's health every frame instead. The fuzzed pad taps A on a quarter of
+// frames, which kills enemies about as fast as they spawn (a few dozen at most), so -p
+// never fires: enemies pile up until enemy_alloc() runs out of slots, and the multiplexer
+// has more sprites than it can show. A -p run that reaches FRAMES without ever filling
+// the pool fails. Each run prints its peak enemy_count.
+// The stub never runs late, so -l fakes lag: about one frame in 8 gets an extra vblank
+// before it, and one in 32 two, which drives the lag handling through its shedding levels
+// and its catch-up steps. Every run checks that updates keep pace with vblanks.
+// Every frame's OAM and split scroll, and each run's final nametables, are folded into an
+// FNV-1a hash. The same arguments always print the same stdout, so diff it between
+// changes: a changed hash means changed behaviour. -v adds the hash after every frame.
+// Timing goes to stderr. Exits 1 at the first broken invariant.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "survivor_v3.c"
+#include "platform_native.h"
+
+// spawn_tables.s, built from the same formula
+#define SPAWN_X(i) (MIN_X + (i) * (MAX_X - MIN_X + 1) / 256)
+#define SPAWN_Y(i) (MIN_Y + (i) * (MAX_Y - MIN_Y + 1) / 256)
+#define R4(f, i)   f(i), f(i + 1), f(i + 2), f(i + 3)
+#define R16(f, i)  R4(f, i), R4(f, i + 4), R4(f, i + 8), R4(f, i + 12)
+#define R64(f, i)  R16(f, i), R16(f, i + 16), R16(f, i + 32), R16(f, i + 48)
+#define R256(f)    R64(f, 0), R64(f, 64), R64(f, 128), R64(f, 192)
+const unsigned char spawn_x_table[256] = { R256(SPAWN_X) };
+const unsigned char spawn_y_table[256] = { R256(SPAWN_Y) };
+
+#define FNV_PRIME 16777619u
+
+// Slot s of pool p is live (pool.h keeps no flags: a slot is live while it is in p_list)
+#define POOL_LIVE(p, s) (p##_list_pos[s] < p##_count && p##_list[p##_list_pos[s]] == (s))
+
+static unsigned long fuzz_state; // Driver PRNG (xorshift32), separate from the game's
+
+static unsigned long fuzz_rand(void) {
+    fuzz_state ^= (fuzz_state << 13) & 0xFFFFFFFFul;
+    fuzz_state ^= fuzz_state >> 17;
+    fuzz_state ^= (fuzz_state << 5) & 0xFFFFFFFFul;
+    return fuzz_state;
+}
+
+static unsigned long hash_bytes(unsigned long h, const unsigned char* p, unsigned int n) {
+    while (n--) h = ((h ^ *p++) * FNV_PRIME) & 0xFFFFFFFFul;
+    return h;
+}
+
+// Returns what is broken, or NULL.
+static const char* check_invariants(void) {
+    static unsigned char seen[MAX_ENEMIES > MAX_PROJECTILES ? MAX_ENEMIES : MAX_PROJECTILES];
+    unsigned char i, s, c, prev, n, page, end;
+    const unsigned char* oam;
+
+    // Enemy pool: every slot exactly once in the live list or the free stack, positions agree
+    if (enemy_count + enemy_free_count != MAX_ENEMIES) return "live + free enemies != MAX_ENEMIES";
+    memset(seen, 0, sizeof(seen));
+    for (i = 0; i < enemy_count; ++i) {
+        s = enemy_list[i];
+        if (s >= MAX_ENEMIES || seen[s]++) return "enemy_list repeats a slot";
+        if (enemy_type[s] >= ENEMY_TYPES || enemy_phase[s] >= ENEMY_WAVE_PERIOD) return "enemy type or phase out of range";
+        if (enemy_dx[s] < -1 || enemy_dx[s] > 1 || enemy_dy[s] < -1 || enemy_dy[s] > 1) return "enemy heading out of range";
+        if (enemy_list_pos[s] != i) return "enemy_list_pos out of step with enemy_list";
+    }
+    for (i = 0; i < enemy_free_count; ++i) {
+        s = enemy_free[i];
+        if (s >= MAX_ENEMIES || seen[s]++ || POOL_LIVE(enemy, s)) return "enemy_free holds a live slot";
+    }
+
+    // Broad phase: every live enemy exactly once, in the cell under it, links consistent
+    memset(seen, 0, sizeof(seen));
+    for (c = 0, n = 0; c < GRID_CELLS; ++c) {
+        for (s = grid_head[c], prev = NO_SLOT; s != NO_SLOT; prev = s, s = enemy_next[s]) {
+            if (s >= MAX_ENEMIES || seen[s]++) return "grid list loops or repeats a slot";
+            if (!POOL_LIVE(enemy, s)) return "grid holds a dead enemy";
+            if (enemy_prev[s] != prev) return "grid prev link broken";
+            if (enemy_cell[s] != c || GRID_CELL(enemy_x[s], enemy_y[s]) != c) return "enemy linked into the wrong cell";
+            ++n;
+        }
+    }
+    if (n != enemy_count) return "grid doesn't hold every live enemy";
+
+    // Projectile pool
+    if (projectile_count + projectile_free_count != MAX_PROJECTILES) return "live + free projectiles != MAX_PROJECTILES";
+    memset(seen, 0, sizeof(seen));
+    for (i = 0; i < projectile_count; ++i) {
+        s = projectile_list[i];
+        if (s >= MAX_PROJECTILES || seen[s]++) return "projectile_list repeats a slot";
+        if (projectile_list_pos[s] != i) return "projectile_list_pos out of step with projectile_list";
+    }
+    for (i = 0; i < projectile_free_count; ++i) {
+        s = projectile_free[i];
+        if (s >= MAX_PROJECTILES || seen[s]++ || POOL_LIVE(projectile, s)) return "projectile_free holds a live slot";
+    }
+
+    // OAM: writer index in range, and nothing past the end of the page just published shows
+    if (oam_idx > LAST_VALID_OAM_INDEX || (oam_idx & 3)) return "oam_idx out of range";
+    page = oam_ready;
+    if (page != OAM_PAGE_A && page != OAM_PAGE_B) return "no OAM page published this frame";
+    end = oam_prev_end[page & 1]; // 0 = all 64 sprites used
+    oam = OAM_PAGE_PTR(page);
+    if (end != 0 && end / 4 > PLAYER_OAM_OFFSET / 4 + PLAYER_SPRITES + enemy_count + projectile_count) return "more sprites than objects";
+    if (memcmp(oam + SPLIT_OAM_OFFSET, split_sprite, 4)) return "split sprite 0 overwritten";
+    if (native_split_misses) return "split with no sprite 0 on screen (would time out)";
+    for (i = end; i != 0; i += 4) if (oam[i] < HIDE_SPRITE_Y) return "stale sprite left on screen";
+
+    // Playfield streaming: at most one column behind (STREAM_AHEAD has a column of slack)
+    if ((unsigned char)((scroll_x >> 3) + STREAM_AHEAD - stream_column) > 1) return "playfield column streaming fell behind";
+    if (stream_attr_row < PLAYFIELD_ATTR_TOP || stream_attr_row > 8) return "stream_attr_row out of range";
+    for (i = PLAYFIELD_ATTR_TOP * 8; i < ATTR_BYTES; ++i) if (attr_shadow[i]) return "attr_set*() on a streamed attribute row";
+
+    // Player and score
+    if (player_x < MIN_X || player_x > MAX_X || player_y < MIN_Y || player_y > MAX_Y) return "player out of bounds";
+    if (player_health == 0 || player_health > PLAYER_MAX_HEALTH) return "player_health out of range";
+    for (i = 0; i < SCORE_BYTES; ++i) if ((score_bcd[i] & 0x0F) > 9 || (score_bcd[i] >> 4) > 9) return "score isn't BCD";
+
+    // Lag handling and the AI scheduler
+    if (lag_level > LAG_LEVEL_MAX) return "lag_level out of range";
+    if (ai_slices != (lag_level >= LAG_SHED_AI ? AI_SLICES * 2 : AI_SLICES)) return "ai_slices doesn't match lag_level";
+    if (enemy_step != ENEMY_SPEED * ai_slices || enemy_ai_phase >= ai_slices) return "AI step or phase out of step";
+    if (lag_streak > lag_worst_streak || lag_worst_streak > lag_frames) return "lag counters disagree";
+    return NULL;
+}
+
+static unsigned long score_value(void) {
+    unsigned long v = 0; unsigned char i = SCORE_BYTES;
+    while (i--) v = v * 100 + (score_bcd[i] >> 4) * 10 + (score_bcd[i] & 0x0F);
+    return v;
+}
+
+// Holds a random d-pad direction for a random stretch and taps A now and then (never with -p).
+static void next_input(unsigned int* hold, int fire) {
+    unsigned long r;
+    if (*hold == 0) {
+        r = fuzz_rand();
+        native_pad_input[0] = (unsigned char)(r & 0xF0);
+        *hold = 1 + (unsigned int)((r >> 8) & 31);
+    }
+    --*hold;
+    r = fuzz_rand();
+    native_pad_input[0] = (native_pad_input[0] & 0xF0) | ((r & 3) == 0 && fire ? JOY_BTN_A_MASK : 0);
+    native_pad_input[1] = (unsigned char)(r >> 8); // Second pad: noise the game must ignore
+}
+
+int main(int argc, char** argv) {
+    unsigned long frames = 10000, runs = 1, seed = 1, run, total = 0, hash = 2166136261u;
+    unsigned long f, run_hash, r;
+    unsigned char h[4];
+    unsigned int hold;
+    unsigned char peak, behind;
+    int verbose = 0, god = 0, lag = 0, pacifist = 0, i;
+    const char* err;
+    clock_t start;
+
+    for (i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "-f") && i + 1 < argc) frames = strtoul(argv[++i], 0, 0);
+        else if (!strcmp(argv[i], "-r") && i + 1 < argc) runs = strtoul(argv[++i], 0, 0);
+        else if (!strcmp(argv[i], "-s") && i + 1 < argc) seed = strtoul(argv[++i], 0, 0);
+        else if (!strcmp(argv[i], "-g")) god = 1;
+        else if (!strcmp(argv[i], "-l")) lag = 1;
+        else if (!strcmp(argv[i], "-p")) pacifist = 1;
+        else if (!strcmp(argv[i], "-v")) verbose = 1;
+        else { fprintf(stderr, "usage: %s [-f FRAMES] [-r RUNS] [-s SEED] [-g] [-l] [-p] [-v]\n", argv[0]); return 2; }
+    }
+
+    start = clock();
+    for (run = 0; run < runs; ++run) {
+        fuzz_state = (seed + run) * 2654435761u & 0xFFFFFFFFul;
+        if (fuzz_state == 0) fuzz_state = 1;
+        native_reset();
+        run_hash = 2166136261u; hold = 0; f = 0; peak = 0; behind = 0;
+        game_init();
+        rand_seed = (unsigned int)(fuzz_rand() & 0xFFFF) | 1; // Non-zero spawn seed
+        for (; f < frames; ++f) {
+            next_input(&hold, !pacifist);
+            if (lag && ((r = fuzz_rand()) & 7) == 0) { // Vblanks while "logic" ran
+                platform_idle();
+                if ((r & 0x18) == 0) platform_idle();
+            }
+            game_frame();
+            // One update (SCROLL_SPEED pixels) per vblank since game_init(); catch-up stops at a death
+            if (player_health == 0) behind = (unsigned char)(nmi_frame * SCROLL_SPEED - scroll_x);
+            if (god) player_health = PLAYER_MAX_HEALTH;
+            if (player_health == 0) break; // Game over
+            if ((err = check_invariants()) != NULL) {
+                printf("run %lu frame %lu: %s\n", run, f, err);
+                return 1;
+            }
+            if ((unsigned char)(nmi_frame * SCROLL_SPEED - scroll_x) != behind) {
+                printf("run %lu frame %lu: updates fell behind vblanks\n", run, f);
+                return 1;
+            }
+            if (enemy_count > peak) peak = enemy_count;
+            run_hash = hash_bytes(run_hash, native_oam, 256);
+            h[0] = (unsigned char)native_split_x; h[1] = (unsigned char)(native_split_x >> 8);
+            run_hash = hash_bytes(run_hash, h, 2);
+            if (verbose) printf("run %lu frame %lu hash %08lx\n", run, f, run_hash);
+        }
+        run_hash = hash_bytes(run_hash, native_vram + NAMETABLE_A, 0x800); // Nametables A and B
+        printf("run %lu frames %lu score %lu enemies %u peak %u sfx %lu %s hash %08lx\n", run, f,
+               score_value(), enemy_count, peak, native_sfx_count, f < frames ? "game-over" : "alive", run_hash);
+        if (pacifist && f == frames && peak != MAX_ENEMIES) {
+            printf("run %lu: the enemy pool never filled\n", run);
+            return 1;
+        }
+        h[0] = (unsigned char)run_hash; h[1] = (unsigned char)(run_hash >> 8);
+        h[2] = (unsigned char)(run_hash >> 16); h[3] = (unsigned char)(run_hash >> 24);
+        hash = hash_bytes(hash, h, 4);
+        total += f;
+    }
+    printf("total frames %lu hash %08lx\n", total, hash);
+    fprintf(stderr, "%.0f frames/s\n", total / ((double)(clock() - start) / CLOCKS_PER_SEC + 1e-9));
+    return 0;
+}
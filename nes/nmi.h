@@ -0,0 +1,8 @@
+#ifndef NMI_H
+#define NMI_H
+
+// --- NMI State (nmi.s) ---
+extern volatile unsigned char nmi_frame; // Incremented once per vblank
+extern volatile unsigned char oam_ready; // Completed OAM page ($02/$03) for the next DMA, 0 = repeat the last
+
+#endif
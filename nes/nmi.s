@@ -0,0 +1,179 @@
+;
+; nmi.s - vblank work for the NES programs, run from the NMI handler.
+;
+; cc65's NES startup code (crt0) saves A/X/Y in its NMI handler and then calls
+; ppubuf_flush, the conio PPU buffer flush, before it resets the PPU address and
+; scroll. None of our programs use conio, so this module exports ppubuf_flush in
+; place of the library one and does the vblank work there: OAM DMA of the last
+; completed OAM page, the frame counter, then the VRAM update queue (vram_queue.c)
+; and last the APU registers prepared by the sound engine (sound.s).
+; crt0 then points the PPU at $2000 with scroll 0, 0 for the next frame, unless
+; split_on is set: then split.s makes those resets and the status bar split, and
+; ends the handler itself.
+; Only A/X/Y are touched: the C runtime zero page belongs to the interrupted code.
+;
+
+        .export         ppubuf_flush
+        .export         _vram_queue, _vram_queue_head, _vram_queue_tail
+        .export         _oam_ready, _nmi_frame, oam_shown
+        .export         _apu_regs, _apu_ready
+        .import         _vram_ctrl, _split_on, split_nmi
+
+PPU_CTRL          = $2000
+PPU_STATUS        = $2002
+PPU_SPR_ADDR      = $2003
+PPU_VRAM_ADDR2    = $2006
+PPU_VRAM_IO       = $2007
+APU_SPR_DMA       = $4014
+APU_PULSE1        = $4000               ; Each channel: control, -, period low, period high
+APU_PULSE2        = $4004
+APU_TRIANGLE      = $4008
+APU_NOISE         = $400C
+
+VRAM_QUEUE_BUDGET = 64                  ; Keep in sync with vram_queue.h
+VRAM_QUEUE_COLUMN = $80                 ; Address high bit 7: column run (vram_queue.h)
+APU_HI_SENT       = $80                 ; apu_regs period high: nothing new to write
+CTRL_INC32        = $04                 ; PPU.control: +32 after each data access
+
+.segment        "BSS"
+
+_vram_queue:      .res    256           ; Ring of [len] [addr hi] [addr lo] [data...]
+_vram_queue_head: .res    1             ; Producer index (game code)
+_vram_queue_tail: .res    1             ; Consumer index (NMI)
+budget:           .res    1             ; Data bytes left this vblank
+column:           .res    1             ; VRAM_QUEUE_COLUMN while the PPU is in +32 mode
+_oam_ready:       .res    1             ; OAM page the game just completed, 0 = none new
+oam_shown:        .res    1             ; OAM page sent every vblank, 0 = none yet
+_nmi_frame:       .res    1             ; Incremented once per vblank
+_apu_regs:        .res    16            ; $4000-$400F as the sound engine wants them
+_apu_ready:       .res    1             ; apu_regs complete and not yet copied
+
+.segment        "CODE"
+
+; ------------------------------------------------------------------------
+; Take the newest completed OAM page, if any, and DMA the page on show. When the
+; game hasn't finished a page since the last vblank the previous one is repeated,
+; so a long logic frame never shows a half-built sprite list.
+
+ppubuf_flush:
+        lda     _oam_ready
+        beq     @dma                    ; Nothing new: repeat the last page
+        sta     oam_shown
+        lda     #0
+        sta     _oam_ready
+@dma:   lda     oam_shown
+        beq     @tick                   ; No page completed yet
+        ldx     #0
+        stx     PPU_SPR_ADDR
+        sta     APU_SPR_DMA
+@tick:  inc     _nmi_frame
+
+; ------------------------------------------------------------------------
+; Send whole queued runs to the PPU until the queue is empty or the next run
+; doesn't fit in what is left of VRAM_QUEUE_BUDGET; that run waits a frame.
+; PPU.control is only written when a run's direction differs from the last
+; one's, and put back to vram_ctrl at the end, so row-only programs never
+; touch it. An empty queue doesn't read PPU.status either: that read clears
+; the vblank flag, which waitvsync() (hello.c's frame loop) polls.
+
+vram_queue_drain:
+        ldx     _vram_queue_tail
+        cpx     _vram_queue_head
+        beq     apu_update              ; Queue empty
+        bit     PPU_STATUS              ; Reset the address latch
+        lda     #VRAM_QUEUE_BUDGET
+        sta     budget
+@run:   cpx     _vram_queue_head
+        beq     @done                   ; Queue empty
+        lda     _vram_queue,x           ; Run length
+        cmp     budget
+        beq     @fits
+        bcs     @done                   ; Longer than the budget left
+@fits:  tay
+        eor     #$FF                    ; budget -= len
+        sec
+        adc     budget
+        sta     budget
+        inx
+        lda     _vram_queue,x           ; Address high
+        eor     column
+        bpl     @addr                   ; Same direction as the last run
+        lda     column
+        eor     #VRAM_QUEUE_COLUMN
+        sta     column
+        jsr     set_ctrl                ; Before the address: it changes the PPU's nametable bits
+@addr:  lda     _vram_queue,x
+        sta     PPU_VRAM_ADDR2          ; The PPU ignores bits 6-7
+        inx
+        lda     _vram_queue,x           ; Address low
+        sta     PPU_VRAM_ADDR2
+        inx
+@byte:  lda     _vram_queue,x
+        sta     PPU_VRAM_IO
+        inx
+        dey
+        bne     @byte
+        jmp     @run
+@done:  stx     _vram_queue_tail
+        lda     column
+        beq     apu_update
+        lda     #0
+        sta     column
+        jsr     set_ctrl                ; Back to +1
+
+; ------------------------------------------------------------------------
+; Copy the sound engine's registers once it has finished a new set, so the
+; APU changes at the same point of every frame however long the game's frame
+; took; otherwise the last set keeps playing. Period high bytes are written
+; only when queued (bit 7 clear) and then marked sent: each write restarts a
+; pulse's waveform. At most about 130 cycles with a new set, 13 without.
+; The APU has no timing window, so this comes after the PPU work.
+
+apu_update:
+        lda     _apu_ready
+        beq     @exit
+        ldx     #0
+        stx     _apu_ready
+        ldy     #APU_HI_SENT
+        lda     _apu_regs+0
+        sta     APU_PULSE1
+        lda     _apu_regs+2
+        sta     APU_PULSE1+2
+        lda     _apu_regs+3
+        bmi     @pulse2
+        sta     APU_PULSE1+3
+        sty     _apu_regs+3
+@pulse2:
+        lda     _apu_regs+4
+        sta     APU_PULSE2
+        lda     _apu_regs+6
+        sta     APU_PULSE2+2
+        lda     _apu_regs+7
+        bmi     @tri
+        sta     APU_PULSE2+3
+        sty     _apu_regs+7
+@tri:   lda     _apu_regs+8
+        sta     APU_TRIANGLE
+        lda     _apu_regs+10
+        sta     APU_TRIANGLE+2
+        lda     _apu_regs+11
+        bmi     @noise
+        sta     APU_TRIANGLE+3
+        sty     _apu_regs+11
+@noise: lda     _apu_regs+12
+        sta     APU_NOISE
+        lda     _apu_regs+14
+        sta     APU_NOISE+2             ; Its length counter was loaded once, by sound_init()
+@exit:  lda     _split_on
+        beq     @done
+        jmp     split_nmi               ; Ends the NMI handler itself (split.s)
+@done:  rts
+
+; PPU.control = vram_ctrl, with +32 increments while column is set. Keeps X and Y.
+set_ctrl:
+        lda     _vram_ctrl
+        bit     column
+        bpl     @store
+        ora     #CTRL_INC32
+@store: sta     PPU_CTRL
+        rts
@@ -0,0 +1,62 @@
+#ifndef PLATFORM_H
+#define PLATFORM_H
+
+// --- Platform Layer ---
+// survivor_v3.c reaches the hardware only through this header and the asm-backed
+// modules (nmi.h, input.h, rand.h, vram.h). For the NES everything below maps straight onto the
+// registers and cc65's library. Building with -DNATIVE swaps in a headless stub backend,
+// native/platform_native.c, which emulates the NMI and records OAM and VRAM writes.
+
+#include "vram.h"
+
+#ifndef NATIVE
+
+#include <nes.h>
+
+#define OAM_PAGE_PTR(page)   ((unsigned char*)((page) << 8)) // OAM page number -> RAM
+#define ppu_ctrl(v)          (vram_ctrl = (v), PPU.control = vram_ctrl) // Keeps vram.s's shadow current
+#define ppu_mask(v)          (PPU.mask = (v))
+#define ppu_scroll(x, y)     (PPU.scroll = (x), PPU.scroll = (y))
+#define ppu_addr(a)          (PPU.vram.address = (unsigned char)((a) >> 8), PPU.vram.address = (unsigned char)(a))
+#define ppu_data(v)          (PPU.vram.data = (v))
+#define platform_waitvsync() waitvsync()
+#define platform_idle()                 // Spin-wait body: the NMI does the work
+
+#else // NATIVE
+
+// Joypad masks and colours as in cc65's nes.h
+#define JOY_UP_MASK      0x10
+#define JOY_DOWN_MASK    0x20
+#define JOY_LEFT_MASK    0x40
+#define JOY_RIGHT_MASK   0x80
+#define JOY_BTN_A_MASK   0x01
+#define JOY_BTN_B_MASK   0x02
+#define JOY_SELECT_MASK  0x04
+#define JOY_START_MASK   0x08
+#define COLOR_BLACK      0x0F
+#define COLOR_WHITE      0x20
+#define COLOR_RED        0x16
+#define COLOR_CYAN       0x2C
+#define COLOR_VIOLET     0x14
+#define COLOR_GREEN      0x1A
+#define COLOR_BLUE       0x12
+#define COLOR_YELLOW     0x28
+#define COLOR_ORANGE     0x27
+#define COLOR_BROWN      0x18
+#define COLOR_LIGHTRED   0x26
+#define COLOR_LIGHTGREEN 0x2A
+#define COLOR_LIGHTBLUE  0x22
+
+extern unsigned char native_oam_ram[512]; // Stands in for $0200-$03FF
+#define OAM_PAGE_PTR(page)   (native_oam_ram + (((page) & 1) << 8))
+void ppu_ctrl(unsigned char v);
+void ppu_mask(unsigned char v);
+void ppu_scroll(unsigned char x, unsigned char y);
+void ppu_addr(unsigned int a);
+void ppu_data(unsigned char v);
+void platform_waitvsync(void);
+void platform_idle(void);                 // Runs one emulated vblank (NMI)
+
+#endif
+
+#endif
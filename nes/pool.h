@@ -0,0 +1,66 @@
+#ifndef POOL_H
+#define POOL_H
+
+// --- Entity Pools ---
+// A pool is a fixed-capacity set of entities with the same layout the game has always
+// used: parallel arrays (p_x[i] is one absolute,X load for cc65), live slots packed in
+// p_list so per-frame passes touch only live entities, and free slots on a stack so alloc
+// and kill are O(1). Everything is generated per pool from macros with the capacity as a
+// constant, so there are no pool descriptors or pointers to go through at run time.
+//
+// For a pool p (a lowercase name such as enemy) of capacity CAP (at most 255):
+//   POOL_STORAGE(p, CAP)        the arrays below; goes with the other globals
+//   unsigned char p_count;      live entities: declare it yourself, in zero page if hot
+//   POOL_FUNCTIONS(p, CAP, on_kill)  p_init(), p_alloc() and p_kill(), after on_kill
+//
+// Per-pool sprite and hitbox constants stay with the game's other configuration; the
+// OAM writer emits a pool's sprites with its own kernel (see survivor_v3.c).
+// A slot is live while it is in p_list; nothing else marks it, so a pool costs no per-slot
+// flag byte and alloc/kill only touch the two lists.
+#define NO_SLOT                0xFF // Returned by p_alloc() when the pool is full
+
+#define POOL_STORAGE(p, CAP) \
+    unsigned char p##_x[CAP], p##_y[CAP]; /* Position */ \
+    unsigned char p##_list[CAP];     /* Live slots, [0, p_count) */ \
+    unsigned char p##_list_pos[CAP]; /* Position of each live slot in p_list */ \
+    unsigned char p##_free[CAP];     /* Free slot stack, [0, p_free_count) */ \
+    unsigned char p##_free_count
+
+// on_kill(slot) runs before a slot is freed (pass POOL_NO_HOOK for none). p_alloc() returns
+// the new slot or NO_SLOT, and p_kill() takes a position in p_list: the last entry moves
+// into it.
+#define POOL_NO_HOOK(slot)
+
+#define POOL_FUNCTIONS(p, CAP, on_kill) \
+    void p##_init(void) { \
+        unsigned char i; \
+        for (i = 0; i < (CAP); ++i) p##_free[i] = i; \
+        p##_free_count = (CAP); p##_count = 0; \
+    } \
+    unsigned char p##_alloc(void) { \
+        unsigned char i; \
+        if (p##_free_count == 0) return NO_SLOT; \
+        i = p##_free[--p##_free_count]; \
+        p##_list_pos[i] = p##_count; \
+        p##_list[p##_count++] = i; \
+        return i; \
+    } \
+    void p##_kill(unsigned char n) { \
+        unsigned char i = p##_list[n], last; \
+        on_kill(i); \
+        p##_free[p##_free_count++] = i; \
+        last = p##_list[--p##_count]; \
+        p##_list[n] = last; p##_list_pos[last] = n; \
+    }
+
+// Update kernels. Both set pos and slot (use zero-page variables) for each live entity
+// and evaluate step, an expression, for it. POOL_UPDATE visits every entity, and step
+// yields 0 when it killed the one at pos (whose list entry then holds the next to visit).
+// POOL_UPDATE_SLICE visits positions first, first + stride, ... and must not kill.
+#define POOL_UPDATE(p, pos, slot, step) \
+    for ((pos) = 0; (pos) < p##_count; ) { (slot) = p##_list[pos]; if (step) ++(pos); }
+
+#define POOL_UPDATE_SLICE(p, pos, slot, first, stride, step) \
+    for ((pos) = (first); (pos) < p##_count; (pos) += (stride)) { (slot) = p##_list[pos]; step; }
+
+#endif
@@ -0,0 +1,96 @@
+#include <nes.h>
+#include "profile.h"
+#include "nmi.h"
+#include "vram_queue.h"
+#include "text.h"
+
+// --- Frame Profiler (see profile.h) ---
+// There is no readable timer on an NROM board, so a section is timed by owning a whole
+// frame: prof_begin() waits for the next NMI, the section runs, and prof_end() counts
+// the scanlines left until the following NMI (prof_idle_lines in profile.s). The frame
+// therefore runs late by a frame or two every PROF_PROBE_INTERVAL frames.
+// Section 0 is meant to be empty: its reading is the NMI handler plus the probe's own
+// overhead, which every other reading includes too.
+
+#define PROF_FRAME_LINES 262 // NTSC scanlines per frame
+#define PROF_TEXT_LEN    (PROF_SECTIONS * 6 - 1) // "0:123 1:045 ..."
+#define PROF_TEXT_ADDR   (0x2000 + PROF_TEXT_Y * 32 + 1) // Nametable A
+#define PROF_LAG_LEN     11 // "L:012 S:003" (lag frames, worst streak)
+#define PROF_LAG_ADDR    (PROF_TEXT_ADDR + 32) // Row below the sections
+
+unsigned char prof_idle_lines(void); // profile.s
+
+static const unsigned char prof_tint[PROF_SECTIONS] = { 0x00, 0x20, 0x40, 0x80, 0x01 }; // -, red, green, blue, grey
+static unsigned char prof_worst[PROF_SECTIONS];      // Worst scanlines per section
+static unsigned char prof_dirty = 1;                 // Readout needs redrawing
+static unsigned char prof_frames;                    // Frames until the next probe
+static unsigned char prof_next;                      // Section the next probe times
+static unsigned char prof_probe = PROF_NONE;         // Section timed this frame
+static unsigned char prof_current = PROF_NONE;       // Section running now
+static unsigned char prof_start;                     // nmi_frame before the probe's wait
+static unsigned char prof_stolen;                    // Vblanks probes waited out, see prof_take_stolen
+static unsigned char prof_lag_frames, prof_lag_worst; // Last values passed to prof_lag()
+static unsigned char prof_lag_dirty = 1;             // Lag readout needs redrawing
+
+static void prof_number(unsigned char* text, unsigned char label, unsigned char v) { // "l:123"
+    text[0] = label; text[1] = ':';
+    text_number(text + 2, v, 3);
+}
+
+static void prof_draw(void) {
+    unsigned char text[PROF_TEXT_LEN], i, j;
+    for (i = 0, j = 0; i < PROF_SECTIONS; ++i, j += 6) {
+        prof_number(text + j, '0' + i, prof_worst[i]);
+        if (i != PROF_SECTIONS - 1) text[j + 5] = 0x00; // Blank tile
+    }
+    if (vram_queue_put(PROF_TEXT_ADDR, text, PROF_TEXT_LEN)) prof_dirty = 0;
+}
+
+static void prof_draw_lag(void) {
+    unsigned char text[PROF_LAG_LEN];
+    prof_number(text, 'L', prof_lag_frames); text[5] = 0x00;
+    prof_number(text + 6, 'S', prof_lag_worst);
+    if (vram_queue_put(PROF_LAG_ADDR, text, PROF_LAG_LEN)) prof_lag_dirty = 0;
+}
+
+void prof_lag(unsigned char frames, unsigned char worst) {
+    if (frames != prof_lag_frames || worst != prof_lag_worst) {
+        prof_lag_frames = frames; prof_lag_worst = worst; prof_lag_dirty = 1;
+    }
+}
+
+unsigned char prof_take_stolen(void) {
+    unsigned char n = prof_stolen;
+    prof_stolen = 0;
+    return n;
+}
+
+void prof_frame(void) {
+    if (prof_dirty) prof_draw();
+    if (prof_lag_dirty) prof_draw_lag();
+    if (prof_frames != 0) { --prof_frames; return; }
+    prof_frames = PROF_PROBE_INTERVAL;
+    prof_probe = prof_next;
+    if (++prof_next == PROF_SECTIONS) prof_next = 0;
+}
+
+void prof_begin(unsigned char id) {
+    unsigned char f;
+    prof_current = id;
+    if (id == prof_probe) { f = prof_start = nmi_frame; while (nmi_frame == f) {} } // Start on a fresh frame
+    PPU.mask = PROF_MASK_BASE | prof_tint[id];
+    *(unsigned char*)PROF_PORT = id;
+}
+
+void prof_end(void) {
+    unsigned char lines;
+    PPU.mask = PROF_MASK_BASE;
+    *(unsigned char*)PROF_PORT = PROF_NONE;
+    if (prof_current == prof_probe) {
+        lines = PROF_FRAME_LINES - prof_idle_lines(); // Idle can pass 255 and wrap; the byte result is still right
+        if (lines > prof_worst[prof_current]) { prof_worst[prof_current] = lines; prof_dirty = 1; }
+        prof_stolen += (unsigned char)(nmi_frame - prof_start); // The wait, the section and the idle
+        prof_probe = PROF_NONE;
+    }
+    prof_current = PROF_NONE;
+}
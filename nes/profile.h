@@ -0,0 +1,40 @@
+#ifndef PROFILE_H
+#define PROFILE_H
+
+// --- Frame Profiler (debug builds only: make clean && make PROFILE=1) ---
+// PROF_BEGIN(id) / PROF_END() bracket a section of the frame. Every frame they tint the
+// picture from the current scanline on (PPU.mask emphasis/greyscale, so each section shows
+// up as a coloured raster band) and write the id to PROF_PORT for an emulator to log.
+// Every PROF_PROBE_INTERVAL frames one section, in turn, is timed in scanlines (see
+// profile.c) and the worst case per section is shown on row PROF_TEXT_Y.
+// PROF_LAG(frames, worst) shows the game's lag counters on the row below, and
+// PROF_TAKE_STOLEN() returns (and clears) the vblanks the last probe waited out, which
+// the game must not count as lag.
+// Without PROFILE defined the macros compile to nothing.
+#define PROF_SECTIONS       5      // Section ids 0..4; id 0 is the baseline (see profile.c)
+#define PROF_PORT           0x4018 // Unused on retail consoles; log writes here in an emulator
+#define PROF_NONE           0xFF   // Written to PROF_PORT outside any section
+#define PROF_MASK_BASE      0x1E   // PPU.mask with no tint: BG + sprites on, left columns on
+#define PROF_PROBE_INTERVAL 16     // Frames between timed sections
+#define PROF_TEXT_Y         0      // Nametable row of the readout (in survivor_v3's status bar)
+
+#ifdef PROFILE
+void prof_frame(void);             // Once per frame, right after the vblank wait
+void prof_begin(unsigned char id);
+void prof_end(void);
+void prof_lag(unsigned char frames, unsigned char worst);
+unsigned char prof_take_stolen(void);
+#define PROF_FRAME()     prof_frame()
+#define PROF_BEGIN(id)   prof_begin(id)
+#define PROF_END()       prof_end()
+#define PROF_LAG(frames, worst) prof_lag(frames, worst)
+#define PROF_TAKE_STOLEN() prof_take_stolen()
+#else
+#define PROF_FRAME()
+#define PROF_BEGIN(id)
+#define PROF_END()
+#define PROF_LAG(frames, worst)
+#define PROF_TAKE_STOLEN() 0
+#endif
+
+#endif
@@ -0,0 +1,29 @@
+;
+; profile.s - scanline counter for the frame profiler (profile.c, debug builds).
+;
+
+        .import         _nmi_frame
+        .export         _prof_idle_lines
+
+.segment        "CODE"
+
+; ------------------------------------------------------------------------
+; unsigned char prof_idle_lines(void) - busy-waits until nmi_frame changes and
+; returns how many scanlines that took. One pass of the loop is 114 cycles
+; against 113.67 per NTSC scanline, so a full frame reads about one line short.
+
+_prof_idle_lines:
+        ldy     #0
+        lda     _nmi_frame
+@line:  ldx     #20                     ; 2
+@wait:  dex                             ; 20 x 5 - 1 = 99
+        bne     @wait
+        .assert >@wait = >*, error, "prof_idle_lines: branch crosses a page"
+        nop                             ; 4
+        nop
+        iny                             ; 2
+        cmp     _nmi_frame              ; 4
+        beq     @line                   ; 3
+        tya
+        ldx     #0
+        rts
@@ -0,0 +1,12 @@
+#ifndef RAND_H
+#define RAND_H
+
+// --- PRNG (rand.s) ---
+// 16-bit xorshift in zero page. Seed with any non-zero value; a given seed always
+// produces the same sequence.
+extern unsigned int rand_seed;
+#pragma zpsym ("rand_seed")
+
+unsigned char rand8(void); // Next pseudo-random byte
+
+#endif
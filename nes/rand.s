@@ -0,0 +1,35 @@
+;
+; rand.s - 16-bit xorshift PRNG (x ^= x << 7; x ^= x >> 9; x ^= x << 8).
+;
+; Replaces the 32-bit LCG multiply in C. One call is 30 cycles of work plus the
+; JSR/RTS, and the state lives in zero page. The period is 65535: any non-zero
+; seed visits every other non-zero value, and the same seed always gives the same
+; sequence, so a recorded run replays identically. A zero seed sticks at zero.
+;
+
+        .exportzp       _rand_seed
+        .export         _rand8
+
+.segment        "ZEROPAGE"
+
+_rand_seed:     .res    2               ; Little-endian state, must not be 0
+
+.segment        "CODE"
+
+; ------------------------------------------------------------------------
+; unsigned char rand8(void) - steps the generator, returns the new high byte.
+
+_rand8:
+        lda     _rand_seed+1
+        lsr                             ; C = bit 8
+        lda     _rand_seed
+        ror                             ; A = bits 8..1 (x >> 1 low byte), C = bit 0
+        eor     _rand_seed+1
+        sta     _rand_seed+1            ; High byte of x ^= x << 7
+        ror                             ; Shift in bit 0: x >> 9 of the new value
+        eor     _rand_seed
+        sta     _rand_seed              ; Low byte: x ^= x >> 9
+        eor     _rand_seed+1
+        sta     _rand_seed+1            ; High byte: x ^= x << 8
+        ldx     #0
+        rts
@@ -0,0 +1,41 @@
+#include "score.h"
+
+#pragma static-locals (on)
+
+// --- BCD Score (see score.h) ---
+// The 2A03 has no decimal mode, so digits are added a nibble at a time in software.
+unsigned char score_bcd[SCORE_BYTES];
+
+void score_reset(void) {
+    unsigned char i;
+    for (i = 0; i < SCORE_BYTES; ++i) score_bcd[i] = 0;
+}
+
+unsigned char score_add(unsigned char points) {
+    unsigned char i, old, lo, hi, changed = 0;
+    for (i = 0; i < SCORE_BYTES; ++i) {
+        old = score_bcd[i];
+        lo = (old & 0x0F) + (points & 0x0F);
+        hi = (old >> 4) + (points >> 4);
+        if (lo > 9) { lo -= 10; ++hi; }
+        points = 0;
+        if (hi > 9) { hi -= 10; points = 1; } // Carry into the next byte up
+        hi = (hi << 4) | lo;
+        score_bcd[i] = hi;
+        if (hi != old) changed = ((hi ^ old) & 0xF0) ? i * 2 + 2 : i * 2 + 1;
+        if (points == 0) return changed; // Higher bytes are untouched
+    }
+    for (i = 0; i < SCORE_BYTES; ++i) score_bcd[i] = 0x99; // Carried out of the top digit
+    return SCORE_DIGITS;
+}
+
+void score_digit_tiles(unsigned char* tiles, unsigned char count) {
+    unsigned char d = SCORE_DIGITS, digit, shown = 0;
+    while (d != 0) { // Walk every digit from the top so leading zeros stay blank
+        --d;
+        digit = score_bcd[d >> 1];
+        digit = (d & 1) ? digit >> 4 : digit & 0x0F;
+        if (digit != 0 || d == 0) shown = 1;
+        if (d < count) *tiles++ = shown ? SCORE_TILE_ZERO + digit : SCORE_TILE_BLANK;
+    }
+}
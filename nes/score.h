@@ -0,0 +1,25 @@
+#ifndef SCORE_H
+#define SCORE_H
+
+// --- BCD Score ---
+// The score is packed BCD, two digits per byte, least significant byte first, so adding
+// points never needs the 16-bit divisions by 10000/1000/100/10 that turning a binary
+// score into digit tiles costs. Shared by all the survivor ROMs.
+#define SCORE_BYTES      3    // 6 digits, 0..999999
+#define SCORE_DIGITS     (SCORE_BYTES * 2)
+#define SCORE_TILE_ZERO  0x30 // Digit tiles $30..$39
+#define SCORE_TILE_BLANK 0x00 // Shown for leading zeros
+
+extern unsigned char score_bcd[SCORE_BYTES];
+
+void score_reset(void);
+
+// Adds points (packed BCD, 0x00..0x99), saturating at 999999. Returns how many of the
+// low (rightmost) digits need redrawing: the highest digit that changed and everything
+// to its right, 0 if nothing changed.
+unsigned char score_add(unsigned char points);
+
+// Writes the tiles for the low count digits, leftmost first, into tiles[0..count-1].
+void score_digit_tiles(unsigned char* tiles, unsigned char count);
+
+#endif
@@ -0,0 +1,14 @@
+#ifndef SCREEN_H
+#define SCREEN_H
+
+// --- Full Screens (screens.s) ---
+// Whole-nametable layouts (960 tiles + 64 attribute bytes) stored as vram_unrle()
+// streams (vram.h), so a screen of text costs tens of bytes of ROM instead of 1K and
+// decodes in well under a frame. Load them with rendering and NMIs off.
+extern const unsigned char screen_title[];
+extern const unsigned char screen_game_over[];
+
+#define SCREEN_SCORE_X 16 // screen_game_over: where the final score's digits go,
+#define SCREEN_SCORE_Y 13 // after its "SCORE " label
+
+#endif
@@ -0,0 +1,59 @@
+;
+; screens.s - full-screen layouts, RLE-compressed at assembly time (see screen.h).
+;
+; Each screen is one vram_unrle() stream covering a whole nametable: 960 tiles and
+; then the 64 attribute bytes. A layout is written as text placed at (column, row);
+; the macros fill the gaps with blank-tile runs and check that the stream comes out
+; exactly 1024 bytes long. A screen of a few lines packs into under 80 bytes.
+;
+
+        .include        "charmap.inc"
+        .export         _screen_title, _screen_game_over
+
+; ------------------------------------------------------------------------
+; Stream builders. screen_pos is the nametable offset reached so far.
+
+.macro  fill    count, value            ; count copies of value, in runs of up to 127
+        .repeat (count) / 127
+        .byte   $FF, value
+        .endrepeat
+        .if (count) .mod 127
+        .byte   $80 | ((count) .mod 127), value
+        .endif
+        screen_pos .set screen_pos + (count)
+.endmacro
+
+.macro  screen  name                    ; Starts a stream
+name:
+        screen_pos .set 0
+.endmacro
+
+.macro  at      col, row, str           ; str at (col, row), blank tiles before it
+        .assert (row) * 32 + (col) >= screen_pos, error, "screen text overlaps or is out of order"
+        fill    (row) * 32 + (col) - screen_pos, TEXT_TILE_BLANK
+        .byte   .strlen(str), str
+        screen_pos .set screen_pos + .strlen(str)
+.endmacro
+
+.macro  attrs   value                   ; Blank to the end of the tiles, one palette for all
+        fill    960 - screen_pos, TEXT_TILE_BLANK
+        fill    64, value
+        .assert screen_pos = 1024, error, "screen stream isn't 1024 bytes"
+        .byte   0                       ; End of stream
+.endmacro
+
+.segment        "RODATA"
+
+; Row and column numbers used by C code are in screen.h; keep them in step.
+
+        screen  _screen_title
+        at      12, 9,  "SURVIVOR"
+        at      7,  15, "D-PAD MOVE   A FIRE"
+        at      10, 19, "PRESS START"
+        attrs   $55                     ; BG palette 1 (text)
+
+        screen  _screen_game_over
+        at      11, 9,  "GAME OVER"
+        at      10, 13, "SCORE "        ; Digits drawn after it (SCREEN_SCORE_X/Y)
+        at      10, 19, "PRESS START"
+        attrs   $55
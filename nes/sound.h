@@ -0,0 +1,47 @@
+#ifndef SOUND_H
+#define SOUND_H
+
+// --- Sound (sound.s) ---
+// Music on all four channels plus effects that take a channel over while they play.
+// sound_update() runs once per frame from the frame loop and prepares a copy of the APU
+// registers; the NMI writes it to the APU at the next vblank (nmi.s), so notes change at
+// the same point of every frame. A call costs at most about 1500 cycles (13 scanlines),
+// about 620 on a typical frame, plus at most 130 in the NMI (counted, see sound.s).
+// Tempo follows game updates, not vblanks. A lag frame's vblank writes no new set, and
+// the game's catch-up steps (survivor_v3.c, Lag Handling) call sound_update() again for
+// up to LAG_CATCHUP_MAX missed updates, so the song keeps time through that much lag.
+// Only the last step's set reaches the APU: a note started in between sounds from the
+// next vblank, up to that many frames late and short, and the effect frames in between
+// are skipped. Lag beyond that, and the frames a profiler probe takes, are lost: the
+// music falls a frame further behind for each one.
+//
+// Channels: 0 and 1 pulse, 2 triangle, 3 noise.
+// Song: per channel, in order, a pointer to its order list and an instrument byte
+// (duty in bits 6-7 and start volume 1-15 in bits 0-3; the triangle only needs it
+// non-zero). Volume falls a step a frame to half the start and holds there.
+// Order list: pattern pointers, then 0; it loops forever.
+// Pattern: bytes, at least one note, ended by SOUND_END (sound.inc has note names):
+//   0x00..0x3F  note (C2 = 0, a semitone a step; noise: period 0-15 + SOUND_NOISE_SHORT)
+//   SOUND_REST  silence, for the current duration
+//   SOUND_DURATION | n  frames per note from here on (1..126)
+// Effect: a channel byte (0, 1 or 3), a priority (1..255), then one [control, note]
+// pair per frame, ended by SOUND_SFX_END. The control byte is the channel's
+// $4000/$4004/$400C value (duty, volume); length halt and fixed volume are added.
+#define SOUND_REST        0x40 // Keep in sync with sound.inc
+#define SOUND_DURATION    0x80
+#define SOUND_END         0xFF
+#define SOUND_SFX_END     0x00
+#define SOUND_NOISE_SHORT 0x10
+
+void sound_init(void);                        // APU on, no song, no effects
+void sound_music(const unsigned char* song);  // Starts song from the top; NULL stops the music
+void sound_sfx(const unsigned char* sfx);     // Ignored while a higher priority one has the channel
+void sound_update(void);                      // Once per frame
+
+// survivor_v3's song and effects (sound_data.s)
+extern const unsigned char song_main[];
+extern const unsigned char sfx_shot[];        // Pulse 2
+extern const unsigned char sfx_kill[];        // Noise
+extern const unsigned char sfx_hit[];         // Pulse 1
+
+#endif
@@ -0,0 +1,347 @@
+;
+; sound.s - music and sound-effect sequencer (see sound.h).
+;
+; sound_update() steps every channel once per frame and leaves the result in
+; apu_regs, a shadow of $4000-$400F that the NMI copies to the APU (nmi.s). The
+; per-frame work is bounded by the data format: a note lasts at least a frame and
+; a pattern holds at least one note, so a channel reads at most one order entry,
+; one duration and one note per frame, and an effect exactly one frame.
+; Cycles per call, jsr and rts included, counted instruction by instruction over
+; two loops of song_main with all three effects started at every frame offset
+; (not a sim65 reading; bench/'s sound kernel is the measured one):
+;   music only              575..1346, 617 on average
+;   effects playing         1492 at most (13 scanlines)
+;   any data placement      1604 at most, if every indexed read and taken
+;                           branch crossed a page
+; The worst frames are every channel starting a note at the top of a looping
+; order list while effects play or end on three of them.
+;
+
+        .include        "zeropage.inc"
+        .include        "sound.inc"
+        .import         _apu_regs, _apu_ready
+        .export         _sound_init, _sound_music, _sound_sfx, _sound_update
+
+APU_PULSE1_SWEEP  = $4001
+APU_PULSE2_SWEEP  = $4005
+APU_NOISE_LENGTH  = $400F
+APU_STATUS        = $4015
+APU_FRAME         = $4017
+
+CHANNELS          = 4                   ; 0, 1 pulses, 2 triangle, 3 noise
+TRIANGLE          = 2
+NOISE             = 3
+
+CTRL_CONST        = $30                 ; $4000/$4004/$400C: length counter halted, fixed volume
+TRI_ON            = $FF                 ; $4008: linear counter held at its maximum
+TRI_OFF           = $80                 ; $4008: linear counter reloads to 0
+HI_LENGTH         = $08                 ; Period high bits 3-7: any non-zero length (halted)
+SWEEP_OFF         = $08                 ; Negate on, so sweep never mutes low notes
+
+.segment        "BSS"
+
+ch_order_lo:      .res    CHANNELS      ; Next order list entry, high byte 0 = channel off
+ch_order_hi:      .res    CHANNELS
+ch_loop_lo:       .res    CHANNELS      ; Start of the order list, where it loops to
+ch_loop_hi:       .res    CHANNELS
+ch_pat_lo:        .res    CHANNELS      ; Next pattern byte
+ch_pat_hi:        .res    CHANNELS
+ch_timer:         .res    CHANNELS      ; Frames until the next note
+ch_len:           .res    CHANNELS      ; Frames per note
+ch_note:          .res    CHANNELS      ; Last note (kept through rests)
+ch_vol:           .res    CHANNELS      ; Current volume, 0 = silent
+ch_inst:          .res    CHANNELS      ; Duty in bits 6-7, start volume in bits 0-3
+ch_hi:            .res    CHANNELS      ; Period high byte last sent, $FF = send again
+sfx_lo:           .res    CHANNELS      ; Effect's next frame
+sfx_hi:           .res    CHANNELS
+sfx_pri:          .res    CHANNELS      ; Effect's priority, 0 = music owns the channel
+
+.segment        "RODATA"
+
+empty_pattern:    .byte   SOUND_END     ; Where every channel starts: first event loads a pattern
+
+; Pulse periods for notes 0-63, C2 to D#7 (NTSC: 1789773 / (16 * Hz) - 1). The
+; triangle plays the same period an octave lower.
+period_lo:
+        .byte   $AD, $4D, $F3, $9D, $4C, $00, $B8, $74, $34, $F8, $BF, $89
+        .byte   $56, $26, $F9, $CE, $A6, $80, $5C, $3A, $1A, $FB, $DF, $C4
+        .byte   $AB, $93, $7C, $67, $52, $3F, $2D, $1C, $0C, $FD, $EF, $E1
+        .byte   $D5, $C9, $BD, $B3, $A9, $9F, $96, $8E, $86, $7E, $77, $70
+        .byte   $6A, $64, $5E, $59, $54, $4F, $4B, $46, $42, $3F, $3B, $38
+        .byte   $34, $31, $2F, $2C
+period_hi:
+        .byte   $06, $06, $05, $05, $05, $05, $04, $04, $04, $03, $03, $03
+        .byte   $03, $03, $02, $02, $02, $02, $02, $02, $02, $01, $01, $01
+        .byte   $01, $01, $01, $01, $01, $01, $01, $01, $01, $00, $00, $00
+        .byte   $00, $00, $00, $00, $00, $00, $00, $00, $00, $00, $00, $00
+        .byte   $00, $00, $00, $00, $00, $00, $00, $00, $00, $00, $00, $00
+        .byte   $00, $00, $00, $00
+
+.segment        "CODE"
+
+; ------------------------------------------------------------------------
+; void sound_init(void)
+
+_sound_init:
+        lda     #$0F
+        sta     APU_STATUS              ; Pulses, triangle and noise on; DMC off
+        lda     #$40
+        sta     APU_FRAME               ; No frame counter IRQ
+        lda     #SWEEP_OFF
+        sta     APU_PULSE1_SWEEP
+        sta     APU_PULSE2_SWEEP
+        sta     APU_NOISE_LENGTH        ; Loads the noise length counter, halted from then on
+        lda     #0
+        ldx     #CHANNELS - 1
+@sfx:   sta     sfx_pri,x
+        dex
+        bpl     @sfx
+        tax                             ; No song: fall through with NULL
+
+; ------------------------------------------------------------------------
+; void sound_music(const unsigned char* song)
+
+_sound_music:
+        sta     ptr1
+        stx     ptr1+1
+        ldx     #CHANNELS - 1
+@chan:  lda     #1
+        sta     ch_timer,x              ; First event on the next update...
+        sta     ch_len,x
+        lda     #<empty_pattern         ; ...which moves to the first pattern
+        sta     ch_pat_lo,x
+        lda     #>empty_pattern
+        sta     ch_pat_hi,x
+        lda     #$FF
+        sta     ch_hi,x
+        lda     #0
+        sta     ch_vol,x
+        sta     ch_note,x
+        ldy     ptr1+1
+        beq     @off                    ; NULL: every channel off
+        txa                             ; Header: order list (2 bytes), instrument per channel
+        sta     tmp1
+        asl     a
+        adc     tmp1
+        tay
+        lda     (ptr1),y                ; Order list
+        sta     ch_order_lo,x
+        sta     ch_loop_lo,x
+        iny
+        lda     (ptr1),y
+        iny
+        sta     ch_loop_hi,x
+        lda     (ptr1),y                ; Instrument
+        sta     ch_inst,x
+        lda     ch_loop_hi,x
+@off:   sta     ch_order_hi,x
+        dex
+        bpl     @chan
+        rts
+
+; ------------------------------------------------------------------------
+; void sound_sfx(const unsigned char* sfx)
+
+_sound_sfx:
+        sta     ptr1
+        stx     ptr1+1
+        ldy     #0
+        lda     (ptr1),y                ; Channel
+        tax
+        iny
+        lda     (ptr1),y                ; Priority
+        cmp     sfx_pri,x
+        bcc     @busy                   ; Something more important is playing
+        sta     sfx_pri,x
+        lda     ptr1                    ; First frame
+        adc     #1                      ; C set: + 2
+        sta     sfx_lo,x
+        lda     ptr1+1
+        adc     #0
+        sta     sfx_hi,x
+@busy:  rts
+
+; ------------------------------------------------------------------------
+; void sound_update(void)
+;
+; Per channel: the effect, if any, plays its next frame into apu_regs; the
+; music always advances, so it is back in time when the effect ends, but only
+; writes apu_regs while no effect has the channel. A lag catch-up step can run
+; it again before the NMI has taken the last set, so the set is withdrawn
+; while it changes: an NMI in between keeps the old registers a frame.
+
+_sound_update:
+        lda     #0
+        sta     _apu_ready
+        ldx     #CHANNELS - 1
+@chan:  txa
+        asl     a
+        asl     a
+        sta     tmp1                    ; This channel's apu_regs
+        lda     sfx_pri,x
+        beq     @music
+        jsr     sfx_step
+@music: lda     ch_order_hi,x
+        beq     @write                  ; Channel off: silent
+        dec     ch_timer,x
+        beq     @event
+        lda     ch_inst,x               ; Volume falls a step a frame to half the start
+        and     #$0F
+        lsr     a
+        cmp     ch_vol,x
+        bcs     @write
+        dec     ch_vol,x
+        bpl     @write                  ; Always taken
+@event: jsr     next_event
+@write: lda     sfx_pri,x
+        bne     @next                   ; The effect has it
+        jsr     music_write
+@next:  dex
+        bpl     @chan
+        lda     #1
+        sta     _apu_ready              ; For the next NMI
+        rts
+
+; Plays the effect's next frame on channel X, or hands the channel back to the
+; music if it has ended.
+sfx_step:
+        lda     sfx_lo,x
+        sta     ptr1
+        lda     sfx_hi,x
+        sta     ptr1+1
+        ldy     #0
+        lda     (ptr1),y                ; Control byte
+        beq     @end                    ; SOUND_SFX_END
+        ora     #CTRL_CONST
+        ldy     tmp1
+        sta     _apu_regs,y
+        ldy     #1
+        lda     (ptr1),y                ; Note
+        jsr     set_period
+        lda     ptr1
+        clc
+        adc     #2
+        sta     sfx_lo,x
+        lda     ptr1+1
+        adc     #0
+        sta     sfx_hi,x
+        rts
+@end:   sta     sfx_pri,x
+        rts
+
+; Reads channel X's next [duration] note, moving on to the next pattern first
+; if this one has ended.
+next_event:
+        lda     ch_pat_lo,x
+        sta     ptr1
+        lda     ch_pat_hi,x
+        sta     ptr1+1
+        ldy     #0
+        lda     (ptr1),y
+        cmp     #SOUND_END
+        bne     @event
+        jsr     next_pattern
+@event: cmp     #SOUND_DURATION
+        bcc     @note
+        and     #$7F
+        sta     ch_len,x
+        iny
+        lda     (ptr1),y
+@note:  cmp     #SOUND_REST
+        bne     @play
+        lda     #0                      ; Rest: silent, note kept
+        beq     @vol                    ; Always taken
+@play:  sta     ch_note,x
+        lda     ch_inst,x
+        and     #$0F
+@vol:   sta     ch_vol,x
+        iny
+        tya
+        clc
+        adc     ptr1
+        sta     ch_pat_lo,x
+        lda     ptr1+1
+        adc     #0
+        sta     ch_pat_hi,x
+        lda     ch_len,x
+        sta     ch_timer,x
+        rts
+
+; Points ptr1 at channel X's next pattern from its order list, looping to the
+; top after the 0 entry, and returns its first byte in A with Y = 0.
+next_pattern:
+        lda     ch_order_lo,x
+        sta     ptr2
+        lda     ch_order_hi,x
+        sta     ptr2+1
+        ldy     #1
+        lda     (ptr2),y                ; Pattern high byte, 0 = end of the list
+        bne     @take
+        lda     ch_loop_lo,x
+        sta     ptr2
+        lda     ch_loop_hi,x
+        sta     ptr2+1
+        lda     (ptr2),y
+@take:  sta     ptr1+1
+        dey
+        lda     (ptr2),y
+        sta     ptr1
+        lda     ptr2
+        clc
+        adc     #2
+        sta     ch_order_lo,x
+        lda     ptr2+1
+        adc     #0
+        sta     ch_order_hi,x
+        lda     (ptr1),y
+        rts
+
+; Writes channel X's music state to apu_regs.
+music_write:
+        ldy     tmp1
+        cpx     #TRIANGLE
+        beq     @tri
+        lda     ch_inst,x
+        and     #$C0                    ; Duty
+        ora     #CTRL_CONST
+        ora     ch_vol,x
+        sta     _apu_regs,y
+        lda     ch_note,x
+        jmp     set_period
+@tri:   lda     ch_vol,x
+        beq     @off
+        lda     #TRI_ON
+        bne     @ctrl                   ; Always taken
+@off:   lda     #TRI_OFF
+@ctrl:  sta     _apu_regs,y
+        lda     ch_note,x
+        ; Fall through
+
+; Puts note A's period into channel X's apu_regs (offset tmp1). The high byte
+; is only queued when it changed: writing it restarts a pulse's waveform, which
+; clicks. ch_hi follows what was queued, effect or music, so handing a channel
+; back doesn't resend it. Noise notes are a period, 0-15, plus SOUND_NOISE_SHORT
+; for the metallic mode ($400E bit 7).
+set_period:
+        ldy     tmp1
+        cpx     #NOISE
+        beq     @noise
+        sty     tmp2
+        tay
+        lda     period_lo,y
+        pha
+        lda     period_hi,y
+        ldy     tmp2
+        cmp     ch_hi,x
+        beq     @lo
+        sta     ch_hi,x
+        ora     #HI_LENGTH
+        sta     _apu_regs+3,y           ; The NMI marks it sent (nmi.s)
+@lo:    pla
+        sta     _apu_regs+2,y
+        rts
+@noise: cmp     #SOUND_NOISE_SHORT
+        bcc     @store
+        eor     #SOUND_NOISE_SHORT | $80 ; To bit 7
+@store: sta     _apu_regs+2,y
+        rts
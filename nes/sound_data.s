@@ -0,0 +1,72 @@
+;
+; sound_data.s - survivor_v3's music and sound effects (format in sound.h).
+;
+; One song, Am-F-C-G, 256 frames a loop with an eighth note every 8 frames:
+; lead and harmony on the pulses, bass on the triangle, drums on the noise.
+;
+
+        .include        "sound.inc"
+        .export         _song_main, _sfx_shot, _sfx_kill, _sfx_hit
+
+LEN4              = SOUND_DURATION | 4  ; Note lengths in frames
+LEN8              = SOUND_DURATION | 8
+LEN12             = SOUND_DURATION | 12
+LEN16             = SOUND_DURATION | 16
+LEN24             = SOUND_DURATION | 24
+LEN32             = SOUND_DURATION | 32
+
+KICK              = 12                  ; Noise periods
+SNARE             = 6
+HAT               = 2
+
+.segment        "RODATA"
+
+_song_main:
+        .word   lead_order
+        .byte   $8A                     ; 50% duty, volume 10
+        .word   harmony_order
+        .byte   $45                     ; 25% duty, volume 5
+        .word   bass_order
+        .byte   $0F
+        .word   drum_order
+        .byte   $0A
+
+lead_order:     .word   lead_a, lead_b, 0
+harmony_order:  .word   harmony, 0
+bass_order:     .word   bass_am, bass_f, bass_c, bass_g, 0
+drum_order:     .word   drums, drums, drums, drums, 0
+
+lead_a: .byte   LEN24, E5, LEN8, D5, LEN16, C5, A4
+        .byte   LEN24, C5, LEN8, D5, LEN16, C5, A4, SOUND_END
+lead_b: .byte   LEN24, E5, LEN8, F5, LEN16, G5, E5
+        .byte   LEN32, D5, LEN16, B4, SOUND_REST, SOUND_END
+
+harmony:
+        .byte   LEN16, A4, C5, E5, C5
+        .byte   A4, C5, F5, C5
+        .byte   G4, C5, E5, C5
+        .byte   G4, B4, D5, B4, SOUND_END
+
+bass_am: .byte  LEN8, A3, A3, E4, A3, A3, E4, A3, E4, SOUND_END
+bass_f:  .byte  LEN8, F3, F3, C4, F3, F3, C4, F3, C4, SOUND_END
+bass_c:  .byte  LEN8, C4, C4, G4, C4, C4, G4, C4, G4, SOUND_END
+bass_g:  .byte  LEN8, G3, G3, D4, G3, G3, D4, G3, D4, SOUND_END
+
+drums:  .byte   LEN4, KICK, LEN12, SOUND_REST, LEN4, HAT, LEN12, SOUND_REST
+        .byte   LEN4, SNARE, LEN12, SOUND_REST, LEN4, HAT, LEN12, SOUND_REST, SOUND_END
+
+; Effects: channel, priority, then [control, note] per frame. A new shot restarts
+; the last one; a kill takes the noise from the drums, a hit takes the lead.
+_sfx_shot:
+        .byte   1, 1
+        .byte   $8C, C6, $8A, A5, $88, F5, $86, D5, $84, C5
+        .byte   SOUND_SFX_END
+_sfx_kill:
+        .byte   3, 2
+        .byte   $0F, 4, $0D, 5, $0B, 6, $09, 8, $07, 10, $05, 12, $03, 13
+        .byte   SOUND_SFX_END
+_sfx_hit:
+        .byte   0, 3
+        .byte   $0F, E4, $0F, C4, $0E, DS4, $0D, B3, $0C, D4, $0B, AS3, $0A, CS4
+        .byte   $09, A3, $08, C4, $07, GS3, $06, B3, $05, G3, $04, AS3, $03, FS3
+        .byte   SOUND_SFX_END
@@ -0,0 +1,26 @@
+;
+; spawn_tables.s - ROM tables mapping a random byte onto survivor_v3's spawn ranges.
+;
+; spawn_x_table[r] = MIN_X + r * (MAX_X - MIN_X + 1) / 256, likewise for Y, so a
+; spawn coordinate is one indexed load instead of a software % on a random byte.
+; Every value in range appears once or twice, spread evenly over the range.
+;
+
+        .export         _spawn_x_table, _spawn_y_table
+
+MIN_X = 8                               ; Keep in sync with survivor_v3.c
+MAX_X = 240
+MIN_Y = 16
+MAX_Y = 216
+
+.segment        "RODATA"
+
+_spawn_x_table:
+        .repeat 256, I
+        .byte   MIN_X + I * (MAX_X - MIN_X + 1) / 256
+        .endrepeat
+
+_spawn_y_table:
+        .repeat 256, I
+        .byte   MIN_Y + I * (MAX_Y - MIN_Y + 1) / 256
+        .endrepeat
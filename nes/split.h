@@ -0,0 +1,19 @@
+#ifndef SPLIT_H
+#define SPLIT_H
+
+// --- Status Bar Split (split.s) ---
+// Each vblank the NMI sets the scroll to 0, 0, which shows a fixed status bar at the top
+// of nametable A. While split_on is set it then waits for sprite 0's hit and sets the
+// horizontal scroll, 0..511 across nametables A and B, for the lines below it. The split
+// is part of the NMI, so it happens every frame, lag frames included, and costs the
+// interrupted code the wait down to the split line (vblank plus the bar).
+// The scroll comes with the OAM page on show: split_x[page & 1] is the scroll for the
+// sprites in that page, so set it before publishing the page (oam_ready). A repeated
+// page repeats its scroll, and sprites and playfield never disagree.
+// Sprite 0 must overlap an opaque background pixel on the last line of the bar in every
+// page, with rendering on; if it never hits, the wait gives up after about 74 scanlines
+// and the frame keeps scroll 0. Clear split_on before turning rendering off.
+extern unsigned int split_x[2];  // Scroll below the bar for OAM page A / B (page & 1)
+extern unsigned char split_on;   // Non-zero: split every frame
+
+#endif
@@ -0,0 +1,93 @@
+;
+; split.s - horizontal scroll below a fixed status bar (see split.h).
+;
+; Without a scanline IRQ on NROM, the split line is found by polling the sprite 0
+; hit flag. The flag stays set from the previous frame until the pre-render line,
+; so the wait is: flag clear, then flag set. The writes land within about 30
+; cycles of the hit, well before the PPU copies the horizontal scroll at the end
+; of the line, so the new scroll starts cleanly on the next one.
+;
+; The wait runs at the end of the NMI handler, so every frame is split however
+; long the game's frame runs. crt0's handler pushes A, Y, X, calls ppubuf_flush
+; (nmi.s) and, when that returns, points the PPU at $2000 with scroll 0, 0 and
+; pops the registers; a PPU address write after the split would wreck it. So
+; nmi.s jumps to split_nmi instead of returning: it drops the return address,
+; makes crt0's resets itself, splits, and leaves the interrupt as crt0 would.
+; Keep it in step with crt0's NMI handler (cc65 libsrc/nes/crt0.s).
+;
+; Both waits share one countdown of SPLIT_POLLS polls (11 cycles each, about 74
+; scanlines in all): far more than vblank plus the status bar, but if sprite 0
+; never hits (rendering off, sprite not on screen) the frame goes on unsplit
+; instead of hanging. Only A/X/Y are touched, as in nmi.s.
+;
+
+        .import         _vram_ctrl, oam_shown
+        .export         _split_x, _split_on, split_nmi
+
+PPU_CTRL          = $2000
+PPU_STATUS        = $2002
+PPU_SCROLL        = $2005
+PPU_VRAM_ADDR2    = $2006
+
+SPLIT_POLLS       = 768                 ; Multiple of 256
+
+.segment        "BSS"
+
+_split_x:         .res    4             ; Scroll below the bar per OAM page (page & 1), 16 bits each
+_split_on:        .res    1             ; Non-zero: split every frame
+split_ctrl:       .res    1             ; PPU.control below the split
+split_fine:       .res    1             ; Fine/coarse x below the split
+
+.segment        "CODE"
+
+; ------------------------------------------------------------------------
+; Tail of the NMI handler, jumped to from ppubuf_flush while split_on is set.
+
+split_nmi:
+        pla                             ; ppubuf_flush's return address
+        pla
+        lda     #$20                    ; crt0's resets: PPU address $2000...
+        sta     PPU_VRAM_ADDR2
+        lda     #$00
+        sta     PPU_VRAM_ADDR2
+        sta     PPU_SCROLL              ; ...and scroll 0, 0 for the status bar
+        sta     PPU_SCROLL
+        lda     oam_shown
+        beq     @exit                   ; No sprite 0 on screen yet
+        and     #$01
+        asl     a
+        tax                             ; The page on show's split_x
+        lda     _split_x,x
+        sta     split_fine
+        lda     _split_x+1,x
+        and     #$01                    ; Bit 8 selects nametable B
+        ora     _vram_ctrl
+        sta     split_ctrl
+        ldx     #<SPLIT_POLLS
+        ldy     #>SPLIT_POLLS
+@clear: bit     PPU_STATUS              ; Reading also resets the write latch
+        bvc     @hit
+        dex
+        bne     @clear
+        dey
+        bne     @clear
+        beq     @exit                   ; Timed out: no split this frame
+@hit:   bit     PPU_STATUS
+        bvs     @split
+        dex
+        bne     @hit
+        dey
+        bne     @hit
+        beq     @exit
+@split: lda     split_ctrl
+        sta     PPU_CTRL
+        lda     split_fine
+        sta     PPU_SCROLL
+        lda     #0
+        sta     PPU_SCROLL              ; Y: only used from the next frame, which resets it
+@exit:  pla                             ; crt0's exit: X, Y, A
+        tax
+        pla
+        tay
+        pla
+        rti
@@ -1,5 +1,9 @@
 #include <nes.h>
 #include <string.h> // For memset
+#include "score.h"
+#include "input.h"
+#include "vram.h"
+#include "text.h"
 //#include <stdio.h> // Removed stdio.h
 
 // --- Constants ---
@@ -43,20 +47,11 @@ unsigned char enemy_1_x, enemy_1_y, enemy_1_active;
 unsigned char enemy_2_x, enemy_2_y, enemy_2_active;
 
 // --- Score Variables ---
-unsigned int score = 0;
-unsigned char score_changed = 0; // Still set, but display update is commented out
+unsigned char score_changed = 0; // Low digits to redraw (see score_add); display update is commented out
 
-// --- PPU Helper Functions --- (Same)
-void ppu_set_address(unsigned int addr) { PPU.vram.address = (addr >> 8); PPU.vram.address = (addr & 0xFF); }
-void ppu_write_data(unsigned char data) { PPU.vram.data = data; }
+// --- PPU Helper Functions --- (VRAM writes go through vram.s)
 void trigger_oam_dma(void) { APU.sprite.dma = OAM_PAGE; }
 
-// --- Input Reading --- (Same)
-unsigned char read_joypad1(void) {
-    unsigned char status = 0; unsigned char i; JOYPAD[0] = 1; JOYPAD[0] = 0;
-    for (i = 0; i < 8; ++i) { status >>= 1; if (JOYPAD[0] & 1) { status |= 0x80; }}
-    return status;
-}
 
 // --- Palette Definition --- (Same)
 const unsigned char palette[32] = {
@@ -73,10 +68,9 @@ const unsigned char palette[32] = {
 // --- Text Display Setup ---
 #define SCORE_TEXT_X 10 // X position for "SCORE "
 #define SCORE_TEXT_Y 2  // Y position for text
-#define SCORE_DIGIT_X (SCORE_TEXT_X + 6) // X position where digits start
-#define SCORE_MAX_DIGITS 5 // Display up to 5 digits
+#define SCORE_DIGIT_X (SCORE_TEXT_X + 6) // X position where digits start (after text_score)
 #define SCORE_TEXT_PALETTE_IDX 1
-void set_attribute_byte(unsigned int addr, unsigned char value){ waitvsync(); ppu_set_address(addr); ppu_write_data(value); }
+void set_attribute_byte(unsigned int addr, unsigned char value){ waitvsync(); vram_copy(addr, &value, 1); }
 void set_tile_palette(unsigned char x, unsigned char y, unsigned char pal_idx, unsigned char width) {
     unsigned int start_attr_addr = ATTRIBUTE_A + ((y / 4) * 8) + (x / 4);
     unsigned int end_attr_addr = ATTRIBUTE_A + ((y / 4) * 8) + ((x + width - 1) / 4);
@@ -94,27 +88,21 @@ unsigned char check_collision(unsigned char x1, unsigned char y1, unsigned char
     return collided;
 }
 
-// --- Simple Integer to ASCII for Score --- (Exists but not used by main loop)
-void write_score_digits_vram(unsigned int s) {
-    unsigned char i;
-    unsigned int divisor = 10000;
-    unsigned char digit_tile;
-    for(i = 0; i < SCORE_MAX_DIGITS; ++i) {
-        digit_tile = (s / divisor) % 10;
-        ppu_write_data(digit_tile + 0x30);
-        divisor /= 10;
-    }
+// --- Score ---
+void add_score(unsigned char points) { // points in packed BCD
+    unsigned char n = score_add(points);
+    if (n > score_changed) score_changed = n;
 }
 
 // --- Score Display Update Function --- (Exists but not used by main loop)
+// Writes only the low score_changed digits (all of them after score_reset).
 void update_score_display(void) {
-    unsigned int addr = NAMETABLE_A + (SCORE_TEXT_Y * 32) + SCORE_DIGIT_X;
-    ppu_set_address(addr);
-    write_score_digits_vram(score);
+    unsigned char tiles[SCORE_DIGITS];
+    score_digit_tiles(tiles, score_changed);
+    vram_copy(NAMETABLE_A + (SCORE_TEXT_Y * 32) + SCORE_DIGIT_X + SCORE_DIGITS - score_changed, tiles, score_changed);
 }
 
 int main(void) {
-    unsigned char i;
     unsigned char joy_status;
     unsigned int vram_addr;
 
@@ -122,20 +110,17 @@ int main(void) {
     waitvsync();
     PPU.control = 0x00; // NMI OFF
     PPU.mask = 0x00;    // Screen OFF
-    ppu_set_address(PALETTE_RAM); for (i = 0; i < 32; ++i) { ppu_write_data(palette[i]); }
-    ppu_set_address(NAMETABLE_A); for (vram_addr = 0; vram_addr < 960; ++vram_addr) { ppu_write_data(0x00); }
-    ppu_set_address(ATTRIBUTE_A); for (i = 0; i < 64; ++i) { ppu_write_data(0x00); }
-    set_tile_palette(SCORE_TEXT_X, SCORE_TEXT_Y, SCORE_TEXT_PALETTE_IDX, 6 + SCORE_MAX_DIGITS);
+    vram_copy(PALETTE_RAM, palette, sizeof(palette));
+    vram_fill(NAMETABLE_A, 0x00, 960 + 64); // Nametable and attributes
+    set_tile_palette(SCORE_TEXT_X, SCORE_TEXT_Y, SCORE_TEXT_PALETTE_IDX, 6 + SCORE_DIGITS);
 
     // Write static "SCORE " text ONCE
     vram_addr = NAMETABLE_A + (SCORE_TEXT_Y * 32) + SCORE_TEXT_X;
-    waitvsync(); ppu_set_address(vram_addr);
-    ppu_write_data('S'-'A'+0x41); ppu_write_data('C'-'A'+0x41); ppu_write_data('O'-'A'+0x41);
-    ppu_write_data('R'-'A'+0x41); ppu_write_data('E'-'A'+0x41); ppu_write_data(0x00); // Space (tile 0)
+    waitvsync(); text_draw(vram_addr, text_score);
 
-    // Initial score display write (writes digits "00000")
-    ppu_set_address(NAMETABLE_A + (SCORE_TEXT_Y * 32) + SCORE_DIGIT_X); // Set address for initial digits
-    write_score_digits_vram(score); // Write initial zeros
+    // Initial score display write (writes "0" right-aligned)
+    score_reset(); score_changed = SCORE_DIGITS;
+    update_score_display(); score_changed = 0;
 
     // Initialize OAM Buffer RAM
     memset(oam_buffer, 0xF0, 256);
@@ -163,9 +148,9 @@ int main(void) {
     // --- Main Game Loop ---
     while (1) {
         // Collision Detection and Scoring (score incremented, flag set)
-        if (enemy_0_active && check_collision(player_x, player_y, enemy_0_x, enemy_0_y)) { enemy_0_active = 0; score++; score_changed = 1; }
-        if (enemy_1_active && check_collision(player_x, player_y, enemy_1_x, enemy_1_y)) { enemy_1_active = 0; score++; score_changed = 1; }
-        if (enemy_2_active && check_collision(player_x, player_y, enemy_2_x, enemy_2_y)) { enemy_2_active = 0; score++; score_changed = 1; }
+        if (enemy_0_active && check_collision(player_x, player_y, enemy_0_x, enemy_0_y)) { enemy_0_active = 0; add_score(0x01); }
+        if (enemy_1_active && check_collision(player_x, player_y, enemy_1_x, enemy_1_y)) { enemy_1_active = 0; add_score(0x01); }
+        if (enemy_2_active && check_collision(player_x, player_y, enemy_2_x, enemy_2_y)) { enemy_2_active = 0; add_score(0x01); }
 
         // VBlank Critical Section Start
         waitvsync();
@@ -200,7 +185,7 @@ int main(void) {
 
         // Non-Critical Processing
         // Read Player Input
-        joy_status = read_joypad1();
+        input_update(); joy_status = pad_held[0];
         // Update Player Position Variables
         if ((joy_status & 0x10) && player_y > MIN_Y) player_y--; if ((joy_status & 0x20) && player_y < MAX_Y) player_y++; if ((joy_status & 0x40) && player_x > MIN_X) player_x--; if ((joy_status & 0x80) && player_x < MAX_X) player_x++;
         // Update Enemy Position Variables
@@ -1,5 +1,9 @@
 #include <nes.h>
 #include <string.h> // For memset
+#include "score.h"
+#include "input.h"
+#include "vram.h"
+#include "text.h"
 
 // --- Constants ---
 // PPU VRAM Addresses
@@ -44,8 +48,7 @@ unsigned char player_x;
 unsigned char player_y;
 Enemy enemies[MAX_ENEMIES];
 unsigned char active_enemy_count = 0;
-unsigned int score = 0;
-unsigned char score_changed = 0;
+unsigned char score_changed = 0; // Low score digits to redraw (see score_add)
 unsigned char frame_count = 0;
 unsigned int random_seed = 1;
 
@@ -55,18 +58,9 @@ unsigned char pseudo_rand(void) {
     return (unsigned char)((random_seed >> 8) & 0xFF);
 }
 
-// --- PPU Helpers ---
-void ppu_set_address(unsigned int addr) { PPU.vram.address = (addr >> 8); PPU.vram.address = (addr & 0xFF); }
-void ppu_write_data(unsigned char data) { PPU.vram.data = data; }
+// --- PPU Helpers --- (VRAM writes go through vram.s)
 void trigger_oam_dma(void) { APU.sprite.dma = OAM_PAGE; }
 
-// --- Input ---
-unsigned char read_joypad1(void) {
-    unsigned char status = 0, i;
-    JOYPAD[0] = 1; JOYPAD[0] = 0; // Strobe
-    for (i = 0; i < 8; ++i) { status >>= 1; if (JOYPAD[0] & 1) { status |= 0x80; } }
-    return status;
-}
 
 // --- Palette ---
 const unsigned char palette[32] = {
@@ -83,34 +77,24 @@ const unsigned char palette[32] = {
 // --- Text Display ---
 #define SCORE_TEXT_X 10
 #define SCORE_TEXT_Y 2
-#define SCORE_DIGIT_X (SCORE_TEXT_X + 6)
-#define SCORE_MAX_DIGITS 5
+#define SCORE_DIGIT_X (SCORE_TEXT_X + 6) // After "SCORE " (text_score)
 #define SCORE_TEXT_PALETTE_IDX 1
 
 void set_tile_palette(unsigned char x_tile, unsigned char y_tile, unsigned char pal_idx, unsigned char width_in_tiles) {
-    unsigned int start_attr_addr; unsigned char start_attr_col, end_attr_col, attr_row, current_attr_col, attr_byte_value;
+    unsigned char start_attr_col, end_attr_col, attr_row;
     attr_row = y_tile / 4; start_attr_col = x_tile / 4; end_attr_col = (x_tile + width_in_tiles - 1) / 4;
-    attr_byte_value = (pal_idx & 0x03) * 0x55;
-    for (current_attr_col = start_attr_col; current_attr_col <= end_attr_col; ++current_attr_col) {
-        start_attr_addr = ATTRIBUTE_A + (attr_row * 8) + current_attr_col;
-        ppu_set_address(start_attr_addr); ppu_write_data(attr_byte_value);
-    }
+    vram_fill(ATTRIBUTE_A + (attr_row * 8) + start_attr_col, (pal_idx & 0x03) * 0x55, end_attr_col - start_attr_col + 1);
 }
 
-void write_score_digits_vram(unsigned int s) {
-    unsigned char i, digit_tile, leading_zero = 1; unsigned int divisor = 10000;
-    for(i = 0; i < SCORE_MAX_DIGITS; ++i) {
-        digit_tile = (s / divisor) % 10;
-        if (digit_tile != 0 || !leading_zero || i == SCORE_MAX_DIGITS - 1) {
-            ppu_write_data(digit_tile + 0x30); leading_zero = 0;
-        } else { ppu_write_data(0x00); }
-        divisor /= 10;
-    }
+void add_score(unsigned char points) { // points in packed BCD
+    unsigned char n = score_add(points);
+    if (n > score_changed) score_changed = n;
 }
 
-void update_score_display(void) {
-    unsigned int addr = NAMETABLE_A + (SCORE_TEXT_Y * 32) + SCORE_DIGIT_X;
-    ppu_set_address(addr); write_score_digits_vram(score);
+void update_score_display(void) { // Writes only the low score_changed digits
+    unsigned char tiles[SCORE_DIGITS];
+    score_digit_tiles(tiles, score_changed);
+    vram_copy(NAMETABLE_A + (SCORE_TEXT_Y * 32) + SCORE_DIGIT_X + SCORE_DIGITS - score_changed, tiles, score_changed);
 }
 
 // --- Collision ---
@@ -141,20 +125,16 @@ void spawn_enemy(void) {
 // --- Main ---
 int main(void) {
     unsigned char i, joy_status, oam_idx;
-    unsigned int vram_addr;
 
     // --- Initial Setup --- (Same as before)
     PPU.control = 0x00; PPU.mask = 0x00;
     waitvsync();
-    ppu_set_address(PALETTE_RAM); for (i = 0; i < 32; ++i) { ppu_write_data(palette[i]); }
-    ppu_set_address(NAMETABLE_A); for (vram_addr = 0; vram_addr < 960; ++vram_addr) { ppu_write_data(0x00); }
-    ppu_set_address(ATTRIBUTE_A); for (i = 0; i < 64; ++i) { ppu_write_data(0x00); }
-    set_tile_palette(SCORE_TEXT_X, SCORE_TEXT_Y, SCORE_TEXT_PALETTE_IDX, 6 + SCORE_MAX_DIGITS);
-    vram_addr = NAMETABLE_A + (SCORE_TEXT_Y * 32) + SCORE_TEXT_X;
-    ppu_set_address(vram_addr);
-    ppu_write_data('S'-'A'+0x41); ppu_write_data('C'-'A'+0x41); ppu_write_data('O'-'A'+0x41);
-    ppu_write_data('R'-'A'+0x41); ppu_write_data('E'-'A'+0x41); ppu_write_data(0x00);
-    update_score_display();
+    vram_copy(PALETTE_RAM, palette, sizeof(palette));
+    vram_fill(NAMETABLE_A, 0x00, 960 + 64); // Nametable and attributes
+    set_tile_palette(SCORE_TEXT_X, SCORE_TEXT_Y, SCORE_TEXT_PALETTE_IDX, 6 + SCORE_DIGITS);
+    text_draw(NAMETABLE_A + (SCORE_TEXT_Y * 32) + SCORE_TEXT_X, text_score);
+    score_reset(); score_changed = SCORE_DIGITS;
+    update_score_display(); score_changed = 0;
     memset(oam_buffer, HIDE_SPRITE_Y, 256);
     player_x = 128; player_y = 112;
     for (i = 0; i < MAX_ENEMIES; ++i) { enemies[i].active = 0; } active_enemy_count = 0;
@@ -216,7 +196,7 @@ int main(void) {
 
         // --- Game Logic --- (Input, Spawning, Movement, Collision - Kept the same)
         // Input
-        joy_status = read_joypad1();
+        input_update(); joy_status = pad_held[0];
         if ((joy_status & JOY_UP_MASK)    && player_y > MIN_Y) player_y--;
         if ((joy_status & JOY_DOWN_MASK)  && player_y < MAX_Y) player_y++;
         if ((joy_status & JOY_LEFT_MASK)  && player_x > MIN_X) player_x--;
@@ -234,7 +214,7 @@ int main(void) {
                 if (enemies[i].x < player_x) enemies[i].x++; else if (enemies[i].x > player_x) enemies[i].x--;
                 // Collide
                 if (check_collision(player_x, player_y, enemies[i].x, enemies[i].y)) {
-                    enemies[i].active = 0; active_enemy_count--; score++; score_changed = 1;
+                    enemies[i].active = 0; active_enemy_count--; add_score(0x01);
                 }
             }
         }
@@ -1,104 +1,248 @@
-#include <nes.h>
-#include <string.h> // For memset
+#include "platform.h"
+#include <string.h> // For memset, memcpy
+#include "vram_queue.h"
+#include "vram.h"
+#include "attr.h"
+#include "text.h"
+#include "nmi.h"
+#include "score.h"
+#include "rand.h"
+#include "input.h"
+#include "profile.h"
+#include "pool.h"
+#include "metasprite.h"
+#include "split.h"
+#include "screen.h"
+#include "sound.h"
+
+// Nothing here recurses, so locals live in static storage instead of cc65's software
+// C stack (see also the zero-page block under Global Variables).
+#pragma static-locals (on)
 
 // --- Constants ---
 // PPU VRAM Addresses
 #define NAMETABLE_A     0x2000
+#define NAMETABLE_B     0x2400 // Right of A (the header sets vertical mirroring)
 #define ATTRIBUTE_A     0x23C0
 #define PALETTE_RAM     0x3F00
 
-// Sprite Constants - Using $0200
-#define OAM_ADDRESS     0x0200
-#define OAM_PAGE        0x02 // Page number for OAM DMA ($4014)
+// Sprite Constants - Double-buffered OAM at $0200/$0300
+// The game builds the back page and hands it to the NMI (oam_ready), which DMAs the
+// newest completed page every vblank and repeats the last one if logic runs long.
+#ifndef OAM_PAGE_A // bench/ moves the pages out of the simulator's program area
+#define OAM_PAGE_A      0x02 // Page numbers for OAM DMA ($4014), see OAM_PAGE_PTR
+#define OAM_PAGE_B      0x03
+#endif
 #define MAX_SPRITES     64   // NES hardware limit
 #define HIDE_SPRITE_Y   0xF0 // Y coordinate to hide a sprite
 #define LAST_VALID_OAM_INDEX 252 // (MAX_SPRITES - 1) * 4
 
-// Player Sprite (Sprite 0)
-#define PLAYER_SPRITE_TILE     0x05   // !!! TILE $05 MUST HAVE GRAPHICS IN YOUR CHR !!!
+// Player Sprite (Sprites 1-4 after the split sprite, the player_meta metasprite)
+#define PLAYER_SPRITE_TILE     0x10   // !!! TILES $10-$13 MUST HAVE GRAPHICS IN YOUR CHR !!! (16x16: TL, TR, BL, BR)
 #define PLAYER_SPRITE_PALETTE  0
-#define PLAYER_OAM_OFFSET      0 // OAM starts at index 0 (bytes 0-3)
-#define PLAYER_SPRITE_WIDTH    8
+#define PLAYER_SPRITES         4 // OAM slots kept for the player, shown or not
+#define PLAYER_META_OFFSET     4 // The 16x16 art sits this far up and left of player_x/y, centred on the hitbox
+#define PLAYER_OAM_OFFSET      4 // After the split sprite (bytes 4-19)
+#define PLAYER_SPRITE_WIDTH    8 // Hitbox
 #define PLAYER_SPRITE_HEIGHT   8
 #define PLAYER_MAX_HEALTH      3 // How many hits the player can take
 #define PLAYER_INVINCIBILITY_FRAMES 60 // Frames of invincibility after getting hit (~1 second)
 
-// Enemy Configuration
-#define ENEMY_SPRITE_TILE      0x06   // !!! TILE $06 MUST HAVE GRAPHICS IN YOUR CHR !!!
-#define ENEMY_SPRITE_PALETTE   1
-#define ENEMY_SPRITE_WIDTH     8
-#define ENEMY_SPRITE_HEIGHT    8
-#define MAX_ENEMIES            30 // Max active enemies (ensure MAX_ENEMIES + 1 + MAX_PROJECTILES <= MAX_SPRITES)
+// Enemy Configuration (per-type tile, palette and hitbox: see Enemy Types below)
+#define MAX_ENEMIES            64 // Max active enemies (past 59 sprites the multiplexer flickers them)
+#define ENEMY_SPEED            1  // Pixels per frame, averaged over an AI round (see below)
+
+// Enemy Types
+// Each live enemy has a type byte that indexes ROM tables: its behaviour handler, called
+// through enemy_behaviour[] (one indexed jump, whatever the type), its tile, OAM attribute
+// byte and hitbox. Hitboxes start at the sprite's top-left corner.
+#define ENEMY_HOMING           0  // Steps towards the player
+#define ENEMY_STRAIGHT         1  // Crosses the screen in its spawn direction, wrapping round
+#define ENEMY_SINE             2  // Like ENEMY_STRAIGHT, weaving across its path
+#define ENEMY_BOUNCER          3  // Moves diagonally, bouncing off the play area's edges
+#define ENEMY_TYPES            4
+#define ENEMY_HITBOX_MAX       8  // Largest enemy_type_w/h value; bounds the grid query
+#define ENEMY_WAVE_PERIOD      32 // ENEMY_SINE: frames per weave, entries in enemy_wave_offset
 
 // Projectile Configuration
-#define MAX_PROJECTILES        5  // Max player bullets on screen
+#define MAX_PROJECTILES        12 // Max player bullets on screen
 #define PROJECTILE_SPRITE_TILE 0x07 // !!! TILE $07 MUST HAVE GRAPHICS IN YOUR CHR !!!
 #define PROJECTILE_SPRITE_PALETTE 0 // Use player palette for projectiles
 #define PROJECTILE_SPEED       2  // Pixels per frame movement
 #define PROJECTILE_SPRITE_WIDTH 8 // Assuming 8x8 sprite
 #define PROJECTILE_SPRITE_HEIGHT 8 // Assuming 8x8 sprite
-#define FIRE_BUTTON_MASK       0x80 // Use 0x80 for Button A (standard mapping)
-
-// Screen Boundaries / Spawning
+#define FIRE_BUTTON_MASK       JOY_BTN_A_MASK // Button A (bit 0 in the pad_* masks)
+
+// Sprite Multiplexer
+// The PPU shows at most 8 sprites per scanline, lowest OAM index first. Enemies and
+// projectiles share one circular draw order whose start moves every frame, so a crowded
+// row flickers evenly instead of permanently hiding the same high-index objects.
+#define MUX_OBJECT_COUNT       (MAX_ENEMIES + MAX_PROJECTILES) // Objects behind the pinned player
+#define MUX_ROTATE_STEP        79 // Draw-order advance per frame: a prime above MUX_OBJECT_COUNT,
+                                  // so it is coprime with every live-object count
+#if MUX_ROTATE_STEP <= MUX_OBJECT_COUNT
+#error "MUX_ROTATE_STEP must be a prime larger than MUX_OBJECT_COUNT"
+#endif
+
+// Profiler Sections (make PROFILE=1; raster tint in brackets, see profile.h)
+#define PROF_BASELINE          0 // Empty: NMI handler (split wait included) + probe overhead, in every reading
+#define PROF_PLAYER            1 // [red] Sound, PPU queues, input, movement, firing
+#define PROF_PROJECTILES       2 // [green] Projectile movement and collision
+#define PROF_ENEMIES           3 // [blue] Spawning, enemy movement, player collision
+#define PROF_OAM               4 // [grey] OAM build and publish
+
+// Status Bar and Playfield
+// Tile rows 0..HUD_ROWS-1 of nametable A are the status bar and never scroll. Below
+// it, sprite 0 (SPLIT_SPRITE_*) marks the split line for the NMI (split.h) and the
+// playfield scrolls right across nametables A and B, streaming in one tile column per
+// 8 pixels (see Playfield). Gameplay stays in screen coordinates.
+#define HUD_ROWS               4    // Also the first playfield row: a whole attribute row
+#define HUD_BAR_TILE           0x05 // !!! BG TILE $05 MUST HAVE GRAPHICS IN YOUR CHR !!! (bottom pixel row solid)
+#define SPLIT_OAM_OFFSET       0    // Sprite 0, written once at startup (bytes 0-3)
+#define SPLIT_SPRITE_TILE      0x08 // !!! TILE $08 MUST HAVE GRAPHICS IN YOUR CHR !!! (bottom pixel row solid)
+#define SPLIT_SPRITE_X         16
+#define SPLIT_SPRITE_Y         (HUD_ROWS * 8 - 8) // On the bar (row HUD_ROWS - 1): the hit is its last line
+#define SPLIT_SPRITE_ATTR      0x20 // Behind the background, so the bar hides it
+#define PLAYFIELD_ROWS         (30 - HUD_ROWS) // Tiles per streamed column
+#define PLAYFIELD_ATTR_TOP     (HUD_ROWS / 4)  // First playfield attribute row
+#define MAP_COLUMNS            128 // World width in tile columns (a power of two dividing 256); wraps
+#define MAP_COLUMN_DEFS        8   // Distinct columns in map_column_tiles
+#define SCROLL_SPEED           1   // Pixels per frame (at most 8: one column is streamed per frame)
+#define STREAM_AHEAD           34  // Columns from the left edge to the next one to stream: 33 can
+                                   // show at once, the 34th is a frame of slack for a full queue
+
+// Screen Boundaries / Spawning (MIN_/MAX_ values are mirrored in spawn_tables.s)
 #define MIN_X 8
 #define MAX_X 240 // Max X considering player width (255 - 8)
 #define MIN_Y 16
 #define MAX_Y 216 // Max Y considering player height (224 - 8)
 #define SPAWN_INTERVAL  60 // Frames between enemy spawns
 #define SPAWN_MARGIN    16 // How far off-screen enemies spawn
-
-// --- Structures ---
-typedef struct {
-    unsigned char x;
-    unsigned char y;
-    unsigned char active; // 0 = inactive, 1 = active
-} Enemy;
-
-typedef struct {
-    unsigned char x, y;
-    unsigned char active; // 0 = inactive, 1 = active
-} Projectile;
-
+#define SPAWN_CLAMP(v)  ((v) < 0 ? 0 : (v) > 255 ? 255 : (v)) // Off-screen edges, clamped to a byte
+#define SPAWN_SEED      123 // Non-zero rand8() seed; the same seed replays the same spawns
+
+// --- Entity Storage ---
+// Enemies and projectiles are entity pools (pool.h): parallel arrays rather than 3-byte
+// structs, since enemy_x[i] is a single absolute,X/Y load for cc65 while enemies[i].x
+// needed an i * 3 multiply and a pointer on every access in the hot loops. A new kind of
+// object is one more pool (storage, functions, update step), but drawing it is more than
+// an OAM_PUT_POOL line: the multiplexer's rotation split, MUX_OBJECT_COUNT and the prime
+// MUX_ROTATE_STEP are written for exactly these two pools (see Sprite Multiplexer).
+
+// Broad Phase Grid
+// Live enemies are also linked into 32x32-pixel cells by their top-left corner, so a
+// collision query walks only the (at most 4) cells an overlapping enemy can be in instead
+// of every live enemy. Enemies move a few pixels per update, so relinking is rare.
+#define GRID_CELLS             64 // 8 columns x 8 rows (rows cover y 0..255)
+#define GRID_CELL(x, y)        ((((y) & 0xE0) >> 2) | ((x) >> 5)) // (y / 32) * 8 + x / 32
+
+// Enemy AI Scheduler
+// Enemies run their behaviours in ai_slices round-robin groups: each frame moves only the
+// live-list positions congruent to enemy_ai_phase, by enemy_step (ENEMY_SPEED * ai_slices)
+// pixels, so the movement pass costs enemy_count / ai_slices iterations at the same
+// average speed. Player contact still tests every enemy every frame through the grid.
+#define AI_SLICES              2  // Groups updated in turn (1 = every enemy every frame)
+
+// Lag Handling
+// wait_frame() reports vblanks that went by while the previous frame's logic ran. Each
+// such lag frame raises lag_level a step, and every level sheds more work without changing
+// how far anything moves per update; LAG_RECOVER_FRAMES on-time frames in a row lower it a
+// step. When late vblanks went by, the last update took late frames instead of one, so
+// game_frame() runs the late - 1 updates missed, up to LAG_CATCHUP_MAX, after its own
+// as catch-up steps: scroll, logic and sound only, with no OAM build and the frame's
+// pad minus new presses. That keeps the game at full speed in real time. Approximate:
+// sprites skip the missed updates' positions, a missed update sees the current pad, and
+// more than LAG_CATCHUP_MAX missed at once (or the frames a profiler probe takes on
+// purpose) are still lost, as a slowdown.
+// A lag frame's vblank repeats the last OAM page with the scroll it was published with
+// (split.h), so the screen holds still for a frame; nothing on it moves out of step.
+#define LAG_SHED_AI            1  // From this level enemies move in AI_SLICES * 2 groups
+#define LAG_SHED_SPAWN         2  // ... and spawn at half rate
+#define LAG_SHED_MUX           3  // ... and the multiplexer stops rotating its draw order
+#define LAG_LEVEL_MAX          3
+#define LAG_RECOVER_FRAMES     120 // On-time frames before lag_level drops a step
+#define LAG_CATCHUP_MAX        2   // Most missed updates a frame makes up
+
+
+// --- Zero Page ---
+// Per-frame hot state. The ZEROPAGE segment holds cc65's runtime variables in its first
+// 26 bytes; survivor.cfg widens it to $02-$61 so these fit too, and `make` prints which
+// symbols landed there and how many bytes remain. Zero page isn't cleared at startup,
+// so main() initialises everything here.
+#pragma bss-name (push, "ZEROPAGE")
+unsigned char* oam_buffer;        // Back OAM page being built
+unsigned char oam_idx;            // Next OAM byte the OAM writer fills this frame
+unsigned char player_x, player_y; // Player position
+unsigned char player_hit_timer;   // Player invincibility timer
+unsigned char enemy_count;        // Live entities in each pool (pool.h)
+unsigned char projectile_count;
+unsigned char slot, enemy_slot;   // Main loop: entity slots being processed
+unsigned char pos, enemy_pos;     // Main loop: positions in the live lists
+unsigned char hit;                // Main loop: enemy slot from grid_find_hit()
+unsigned char box_x, box_y, box_w, box_h; // collide_box_enemy() box (player or projectile)
+#pragma bss-name (pop)
+#pragma zpsym ("oam_buffer")      // Lets cc65 use (oam_buffer),y directly
 
 // --- Global Variables ---
-unsigned char* const oam_buffer = (unsigned char*)OAM_ADDRESS; // OAM buffer pointer
-unsigned char player_x, player_y; // Player position
+unsigned char oam_back_page = OAM_PAGE_A; // Page number of oam_buffer
 unsigned char player_health;      // Player health
-unsigned char player_hit_timer;   // Player invincibility timer
-Enemy enemies[MAX_ENEMIES];       // Enemy array
-unsigned char active_enemy_count; // Count of active enemies
-Projectile projectiles[MAX_PROJECTILES]; // Projectile array
-unsigned int score;               // Game score
-unsigned char score_changed;      // Score update flag
+unsigned char player_facing_left; // Draw the player mirrored (last horizontal input was left)
+POOL_STORAGE(enemy, MAX_ENEMIES);           // enemy_x, enemy_y, enemy_list, ...
+unsigned char enemy_type[MAX_ENEMIES];      // ENEMY_* type of each live enemy
+signed char enemy_dx[MAX_ENEMIES], enemy_dy[MAX_ENEMIES]; // Heading (-1, 0, 1) of non-homing types
+unsigned char enemy_phase[MAX_ENEMIES];     // ENEMY_SINE: position in the weave
+POOL_STORAGE(projectile, MAX_PROJECTILES);  // projectile_x, projectile_y, ...
+unsigned char grid_head[GRID_CELLS];        // First enemy slot in each cell, NO_SLOT if empty
+unsigned char enemy_cell[MAX_ENEMIES];      // Cell each live enemy is linked into
+unsigned char enemy_next[MAX_ENEMIES], enemy_prev[MAX_ENEMIES]; // Per-cell doubly linked lists
+unsigned char score_changed;      // Low score digits still to redraw (see score_add)
 unsigned char frame_count;        // Frame counter for spawning
-unsigned int random_seed = 1;     // PRNG seed
-static unsigned char last_joy_status = 0; // Previous joypad state
-
-
-// --- PRNG ---
-unsigned char pseudo_rand(void) {
-    random_seed = (random_seed * 1103515245 + 12345);
-    return (unsigned char)((random_seed >> 8) & 0xFF);
+unsigned char mux_start;          // First object in this frame's draw order
+unsigned char enemy_ai_phase;     // AI group (enemy_list position % ai_slices) moved this frame
+unsigned char ai_slices, enemy_step; // AI groups and pixels per enemy update (see lag_set_level)
+unsigned char lag_level;          // Work being shed, 0..LAG_LEVEL_MAX
+unsigned char lag_calm;           // On-time frames since lag_level last changed
+unsigned char lag_frames;         // Lag frames so far (saturates at 255; PROFILE builds show it)
+unsigned char lag_streak, lag_worst_streak; // Lag frames in a row now, and the longest such run
+unsigned char oam_prev_end[2];    // oam_idx when each page was last built (high-water mark)
+unsigned int scroll_x;            // Playfield scroll in world pixels; published with each OAM page (split_x)
+unsigned char stream_column;      // Next world column to stream (mod 256)
+unsigned char stream_attr_row;    // Attribute row it resumes from if the queue filled up
+static unsigned char last_frame;  // nmi_frame seen by the last wait_frame()
+
+
+// --- Frame Sync ---
+// Waits for the NMI to finish the next vblank (OAM DMA and VRAM queue are done there).
+// Returns how many vblanks had already gone by, i.e. lag frames (0 = on time); a late
+// frame starts at once instead of waiting out another one.
+unsigned char wait_frame(void) {
+    unsigned char late = nmi_frame - last_frame;
+    while (nmi_frame == last_frame) { platform_idle(); }
+    last_frame = nmi_frame;
+    return late;
 }
 
-// --- PPU Helpers ---
-void ppu_set_address(unsigned int addr) {
-    PPU.vram.address = (addr >> 8);
-    PPU.vram.address = (addr & 0xFF);
-}
-void ppu_write_data(unsigned char data) {
-    PPU.vram.data = data;
+// --- Lag Handling ---
+void lag_set_level(unsigned char level) {
+    lag_level = level; lag_calm = 0;
+    ai_slices = (level >= LAG_SHED_AI) ? AI_SLICES * 2 : AI_SLICES;
+    enemy_step = ENEMY_SPEED * ai_slices;
+    enemy_ai_phase = 0; // Must stay below ai_slices
 }
-void trigger_oam_dma(void) {
-    APU.sprite.dma = OAM_PAGE;
-}
-
-// --- Input ---
-unsigned char read_joypad1(void) {
-    unsigned char status = 0, i;
-    JOYPAD[0] = 1; JOYPAD[0] = 0; // Strobe
-    for (i = 0; i < 8; ++i) { status >>= 1; if (JOYPAD[0] & 1) { status |= 0x80; } }
-    return status; // Bit order: A, B, Select, Start, Up, Down, Left, Right (7..0)
+unsigned char lag_update(unsigned char late) { // late = wait_frame(); returns the updates missed
+    unsigned char stolen = PROF_TAKE_STOLEN(); // Profiler probes run late on purpose
+    late = (late > stolen) ? late - stolen : 0;
+    if (late) {
+        lag_frames = (lag_frames > 255 - late) ? 255 : lag_frames + late;
+        lag_streak = (lag_streak > 255 - late) ? 255 : lag_streak + late;
+        if (lag_streak > lag_worst_streak) lag_worst_streak = lag_streak;
+        if (lag_level < LAG_LEVEL_MAX) lag_set_level(lag_level + 1); else lag_calm = 0;
+    } else {
+        lag_streak = 0;
+        if (lag_level != 0 && ++lag_calm == LAG_RECOVER_FRAMES) lag_set_level(lag_level - 1);
+    }
+    PROF_LAG(lag_frames, lag_worst_streak);
+    return late ? late - 1 : 0;
 }
 
 // --- Palette ---
@@ -116,265 +260,542 @@ const unsigned char palette[32] = {
 // --- Text Display ---
 #define SCORE_TEXT_X 10
 #define SCORE_TEXT_Y 2
-#define SCORE_DIGIT_X (SCORE_TEXT_X + 6)
-#define SCORE_MAX_DIGITS 5
+#define SCORE_DIGIT_X (SCORE_TEXT_X + 6) // After "SCORE " (text_score)
 #define SCORE_TEXT_PALETTE_IDX 1
+#if SCORE_TEXT_Y >= PLAYFIELD_ATTR_TOP * 4
+#error "The attribute shadow only owns the status bar's rows (see game_init)"
+#endif
+
+// PPU writes below go through the VRAM queue and land in the next vblank(s); palettes
+// go through the attribute shadow (attr.h), flushed every frame.
+void add_score(unsigned char points) { // points in packed BCD
+    unsigned char n = score_add(points);
+    if (n > score_changed) score_changed = n; // Widen any redraw still pending
+}
+unsigned char update_score_display(void) { // Queues only the changed digits; returns 0 if the queue was full
+    unsigned char tiles[SCORE_DIGITS];
+    score_digit_tiles(tiles, score_changed);
+    return vram_queue_put(NAMETABLE_A + (SCORE_TEXT_Y * 32) + SCORE_DIGIT_X + SCORE_DIGITS - score_changed, tiles, score_changed);
+}
 
-void set_tile_palette(unsigned char x_tile, unsigned char y_tile, unsigned char pal_idx, unsigned char width_in_tiles) {
-    unsigned int start_attr_addr;
-    unsigned char start_attr_col, end_attr_col, attr_row, current_attr_col;
-    attr_row = y_tile / 4; start_attr_col = x_tile / 4; end_attr_col = (x_tile + width_in_tiles - 1) / 4;
-    for (current_attr_col = start_attr_col; current_attr_col <= end_attr_col; ++current_attr_col) {
-        start_attr_addr = ATTRIBUTE_A + (attr_row * 8) + current_attr_col;
-        ppu_set_address(start_attr_addr); ppu_write_data((pal_idx * 0x55));
+// --- Playfield Map ---
+// Dictionary compressed: the map stores one byte per world column, an index into the
+// distinct columns of tiles below, plus one attribute byte per 4 columns (all rows). The
+// whole 1024-pixel map takes 368 bytes instead of 3.5K.
+// !!! BG TILES $01-$04 MUST HAVE GRAPHICS IN YOUR CHR !!! (floor details; $00 is bare floor)
+const unsigned char map_column_tiles[MAP_COLUMN_DEFS][PLAYFIELD_ROWS] = {
+    { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 },
+    { 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 },
+    { 0, 2, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0 },
+    { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 4, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 },
+    { 0, 0, 2, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 },
+    { 0, 4, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0 },
+    { 0, 2, 0, 0, 0, 0, 0, 0, 0, 2, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 },
+    { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2, 1, 0, 0, 0, 0, 0, 0, 0 }
+};
+const unsigned char map_columns[MAP_COLUMNS] = {
+    2, 6, 0, 0, 7, 7, 1, 3, 0, 6, 0, 7, 0, 7, 1, 5, 6, 4, 3, 5, 7, 5, 3, 2, 1, 0, 1, 0, 7, 2, 6, 5,
+    3, 5, 2, 7, 0, 0, 6, 4, 0, 3, 0, 5, 4, 0, 0, 6, 7, 3, 3, 3, 7, 5, 7, 5, 0, 0, 2, 5, 0, 0, 2, 7,
+    5, 2, 4, 3, 0, 5, 3, 0, 7, 0, 5, 0, 1, 2, 0, 1, 4, 4, 5, 0, 0, 5, 4, 6, 2, 0, 4, 6, 2, 4, 3, 4,
+    1, 0, 0, 0, 0, 1, 1, 0, 5, 7, 0, 2, 2, 0, 0, 4, 6, 3, 7, 7, 3, 0, 6, 7, 0, 5, 6, 4, 4, 4, 4, 0
+};
+const unsigned char map_attr[MAP_COLUMNS / 4] = { // Palettes 0, 2 and 3 (1 is the status bar text's)
+    0xFF, 0xFF, 0x00, 0x00, 0x00, 0x00, 0xFF, 0x00, 0x00, 0xAA, 0x00, 0x00, 0x00, 0x00, 0x00, 0xAA,
+    0x00, 0x00, 0x00, 0xFF, 0x00, 0xAA, 0xAA, 0xAA, 0xFF, 0x00, 0x00, 0xFF, 0xFF, 0xFF, 0xFF, 0xAA
+};
+// Sprite 0 as OAM bytes: the split marker (see split.h)
+const unsigned char split_sprite[4] = { SPLIT_SPRITE_Y - 1, SPLIT_SPRITE_TILE, SPLIT_SPRITE_ATTR, SPLIT_SPRITE_X };
+
+// --- Playfield ---
+// World column w lives in nametable column w & 63 (A, then B). Columns are streamed
+// STREAM_AHEAD to the right of the left edge, so each one overwrites a column that
+// scrolled out of view; attribute bytes go with the first column of each group of 4.
+#define PLAYFIELD_NAMETABLE(w)    (((w) & 32) ? NAMETABLE_B : NAMETABLE_A)
+#define PLAYFIELD_ADDR(w)         (PLAYFIELD_NAMETABLE(w) + HUD_ROWS * 32 + ((w) & 31))
+#define PLAYFIELD_ATTR_ADDR(w, r) (PLAYFIELD_NAMETABLE(w) + 0x3C0 + (r) * 8 + (((w) & 31) >> 2))
+
+void playfield_draw(void) { // Draws the first screen at scroll 0; rendering off
+    unsigned char w, r;
+    for (w = 0; w < STREAM_AHEAD; ++w) {
+        vram_copy_stride32(PLAYFIELD_ADDR(w), map_column_tiles[map_columns[w]], PLAYFIELD_ROWS);
+        if ((w & 3) == 0) {
+            for (r = PLAYFIELD_ATTR_TOP; r < 8; ++r) vram_fill(PLAYFIELD_ATTR_ADDR(w, r), map_attr[w >> 2], 1);
+        }
     }
+    scroll_x = 0; stream_column = STREAM_AHEAD; stream_attr_row = PLAYFIELD_ATTR_TOP;
 }
-void write_score_digits_vram(unsigned int s) {
-    unsigned char i, digit_tile, leading_zero = 1; unsigned int divisor = 10000;
-    for(i = 0; i < SCORE_MAX_DIGITS; ++i) {
-        digit_tile = (s / divisor) % 10;
-        if (digit_tile != 0 || !leading_zero || i == SCORE_MAX_DIGITS - 1) {
-            ppu_write_data(digit_tile + 0x30); leading_zero = 0; // Use tile $30..$39
-        } else { ppu_write_data(0x00); } // Use tile $00 (blank)
-        divisor /= 10;
+void playfield_scroll(void) { // Advances the scroll and queues the column it brings due
+    unsigned char m;
+    scroll_x += SCROLL_SPEED;
+    if (stream_column == (unsigned char)((scroll_x >> 3) + STREAM_AHEAD)) return; // Nothing due
+    m = stream_column & (MAP_COLUMNS - 1);
+    if ((stream_column & 3) == 0) {
+        for (; stream_attr_row < 8; ++stream_attr_row) { // One byte per attribute row
+            if (!vram_queue_put(PLAYFIELD_ATTR_ADDR(stream_column, stream_attr_row), &map_attr[m >> 2], 1)) return;
+        }
     }
+    if (!vram_queue_put(PLAYFIELD_ADDR(stream_column) | VRAM_QUEUE_COLUMN, map_column_tiles[map_columns[m]], PLAYFIELD_ROWS)) {
+        return; // Queue full: retried next frame
+    }
+    ++stream_column; stream_attr_row = PLAYFIELD_ATTR_TOP;
 }
-void update_score_display(void) {
-    unsigned int addr = NAMETABLE_A + (SCORE_TEXT_Y * 32) + SCORE_DIGIT_X;
-    ppu_set_address(addr); write_score_digits_vram(score);
-}
+
+// --- Metasprites ---
+// Player art, drawn with oam_meta() (mirrored with oam_meta_flip() when facing left)
+const unsigned char player_meta[] = {
+    8, // Flip span: 16 pixels wide
+    0, PLAYER_SPRITE_TILE + 0, (PLAYER_SPRITE_PALETTE & 0x03), 0,
+    0, PLAYER_SPRITE_TILE + 1, (PLAYER_SPRITE_PALETTE & 0x03), 8,
+    8, PLAYER_SPRITE_TILE + 2, (PLAYER_SPRITE_PALETTE & 0x03), 0,
+    8, PLAYER_SPRITE_TILE + 3, (PLAYER_SPRITE_PALETTE & 0x03), 8,
+    META_END
+};
+
+// --- Enemy Types ---
+// !!! Every type still uses TILE $06 (it MUST HAVE GRAPHICS IN YOUR CHR); give each its own
+// tile here once the CHR has them. Attribute bytes: palette in bits 0-1, flips in bits 6-7.
+const unsigned char enemy_type_tile[ENEMY_TYPES] = { 0x06, 0x06, 0x06, 0x06 };
+const unsigned char enemy_type_attr[ENEMY_TYPES] = { 1, 2, 3, 2 | 0x80 };
+const unsigned char enemy_type_w[ENEMY_TYPES]    = { 8, 8, 7, 6 };
+const unsigned char enemy_type_h[ENEMY_TYPES]    = { 8, 8, 7, 6 };
+// Spawn odds, indexed by a random 0..7: half homing, a quarter straight
+const unsigned char enemy_spawn_type[8] = {
+    ENEMY_HOMING, ENEMY_HOMING, ENEMY_HOMING, ENEMY_HOMING,
+    ENEMY_STRAIGHT, ENEMY_STRAIGHT, ENEMY_SINE, ENEMY_BOUNCER
+};
+// ENEMY_SINE sideways offset, 12 * sin(2 * pi * i / ENEMY_WAVE_PERIOD)
+const signed char enemy_wave_offset[ENEMY_WAVE_PERIOD] = {
+    0, 2, 5, 7, 8, 10, 11, 12, 12, 12, 11, 10, 8, 7, 5, 2,
+    0, -2, -5, -7, -8, -10, -11, -12, -12, -12, -11, -10, -8, -7, -5, -2
+};
 
 // --- Collision ---
-unsigned char check_collision(unsigned char x1, unsigned char y1, unsigned char w1, unsigned char h1,
-                              unsigned char x2, unsigned char y2, unsigned char w2, unsigned char h2) {
-    return (x1 < (x2 + w2) && (x1 + w1) > x2 && y1 < (y2 + h2) && (y1 + h1) > y2);
+// Arguments are passed in zero page instead of on cc65's software stack: the caller sets
+// box_x/y/w/h once for the player or projectile, then tests each enemy_slot against it.
+unsigned char collide_box_enemy(void) {
+    unsigned char t = enemy_type[enemy_slot];
+    return (box_x < (enemy_x[enemy_slot] + enemy_type_w[t]) && (box_x + box_w) > enemy_x[enemy_slot] &&
+            box_y < (enemy_y[enemy_slot] + enemy_type_h[t]) && (box_y + box_h) > enemy_y[enemy_slot]);
 }
 
-// --- Enemy Spawning ---
-void spawn_enemy(void) {
-    unsigned char i, spawn_side; signed int spawn_x_s, spawn_y_s;
-    for (i = 0; i < MAX_ENEMIES; ++i) {
-        if (!enemies[i].active) {
-            enemies[i].active = 1; active_enemy_count++;
-            spawn_side = pseudo_rand() & 3;
-            switch (spawn_side) {
-                case 0: spawn_x_s = MIN_X + (pseudo_rand() % (MAX_X - MIN_X + 1)); spawn_y_s = MIN_Y - SPAWN_MARGIN; break;
-                case 1: spawn_x_s = MIN_X + (pseudo_rand() % (MAX_X - MIN_X + 1)); spawn_y_s = MAX_Y + SPAWN_MARGIN; break;
-                case 2: spawn_x_s = MIN_X - SPAWN_MARGIN; spawn_y_s = MIN_Y + (pseudo_rand() % (MAX_Y - MIN_Y + 1)); break;
-                default:spawn_x_s = MAX_X + SPAWN_MARGIN; spawn_y_s = MIN_Y + (pseudo_rand() % (MAX_Y - MIN_Y + 1)); break;
+// --- Broad Phase Grid ---
+void grid_insert(unsigned char slot) { // Links a live enemy into the cell under its position
+    unsigned char c = GRID_CELL(enemy_x[slot], enemy_y[slot]), head = grid_head[c];
+    enemy_cell[slot] = c; enemy_prev[slot] = NO_SLOT; enemy_next[slot] = head;
+    if (head != NO_SLOT) enemy_prev[head] = slot;
+    grid_head[c] = slot;
+}
+void grid_remove(unsigned char slot) {
+    unsigned char prev = enemy_prev[slot], next = enemy_next[slot];
+    if (prev == NO_SLOT) grid_head[enemy_cell[slot]] = next; else enemy_next[prev] = next;
+    if (next != NO_SLOT) enemy_prev[next] = prev;
+}
+void grid_move(unsigned char slot) { // Call after moving an enemy; relinks only on a cell change
+    if (GRID_CELL(enemy_x[slot], enemy_y[slot]) != enemy_cell[slot]) { grid_remove(slot); grid_insert(slot); }
+}
+// Returns the slot of an enemy overlapping box_x/y/w/h (see collide_box_enemy) or NO_SLOT.
+// An overlapping enemy's top-left lies in [box - (hitbox size - 1), box + box size - 1].
+unsigned char grid_find_hit(void) {
+    unsigned char lo, hi, col_lo, col_hi, row, row_hi, c;
+    lo = (box_x > ENEMY_HITBOX_MAX - 1) ? box_x - (ENEMY_HITBOX_MAX - 1) : 0;
+    hi = (box_x < 256 - box_w) ? box_x + box_w - 1 : 255;
+    col_lo = lo >> 5; col_hi = hi >> 5;
+    lo = (box_y > ENEMY_HITBOX_MAX - 1) ? box_y - (ENEMY_HITBOX_MAX - 1) : 0;
+    hi = (box_y < 256 - box_h) ? box_y + box_h - 1 : 255;
+    row_hi = GRID_CELL(0, hi);
+    for (row = GRID_CELL(0, lo); row <= row_hi; row += 8) {
+        for (c = row + col_lo; c <= row + col_hi; ++c) {
+            for (enemy_slot = grid_head[c]; enemy_slot != NO_SLOT; enemy_slot = enemy_next[enemy_slot]) {
+                if (collide_box_enemy()) return enemy_slot;
             }
-            if (spawn_x_s < 0) enemies[i].x = 0; else if (spawn_x_s > 255) enemies[i].x = 255; else enemies[i].x = (unsigned char)spawn_x_s;
-            if (spawn_y_s < 0) enemies[i].y = 0; else if (spawn_y_s > 255) enemies[i].y = 255; else enemies[i].y = (unsigned char)spawn_y_s;
-            return;
         }
     }
+    return NO_SLOT;
 }
 
-// --- Game Over ---
-void game_over_halt(void) {
-    PPU.mask = 0x00; // Turn off rendering
-    while(1);        // Halt execution
+// --- Entity Lists ---
+// enemy_alloc() callers set the position, then call grid_insert(); enemy_kill() unlinks
+// the enemy from the grid itself.
+POOL_FUNCTIONS(enemy, MAX_ENEMIES, grid_remove)
+POOL_FUNCTIONS(projectile, MAX_PROJECTILES, POOL_NO_HOOK)
+
+void entity_lists_init(void) {
+    memset(grid_head, NO_SLOT, GRID_CELLS);
+    enemy_init();
+    projectile_init();
 }
 
-// --- Main Function ---
-void main(void) {
-    unsigned char i, j; // Loop counters
-    unsigned char joy_status;
-    unsigned int vram_addr;
-    unsigned char oam_idx; // OAM buffer index
+// --- Enemy Spawning ---
+// spawn_tables.s maps a random byte onto [MIN_X, MAX_X] / [MIN_Y, MAX_Y] (no % needed).
+extern const unsigned char spawn_x_table[256], spawn_y_table[256];
+void spawn_enemy(void) {
+    unsigned char i, r;
+    i = enemy_alloc();
+    if (i == NO_SLOT) return;
+    r = rand8(); // Bits 0-2 type, 3-4 side, 5 bouncer's sideways heading
+    enemy_type[i] = enemy_spawn_type[r & 7]; enemy_phase[i] = 0;
+    enemy_dx[i] = enemy_dy[i] = 0;
+    switch ((r >> 3) & 3) { // Spawn side; the heading points into the screen
+        case 0: enemy_x[i] = spawn_x_table[rand8()]; enemy_y[i] = SPAWN_CLAMP(MIN_Y - SPAWN_MARGIN); enemy_dy[i] = 1; break;
+        case 1: enemy_x[i] = spawn_x_table[rand8()]; enemy_y[i] = SPAWN_CLAMP(MAX_Y + SPAWN_MARGIN); enemy_dy[i] = -1; break;
+        case 2: enemy_x[i] = SPAWN_CLAMP(MIN_X - SPAWN_MARGIN); enemy_y[i] = spawn_y_table[rand8()]; enemy_dx[i] = 1; break;
+        default:enemy_x[i] = SPAWN_CLAMP(MAX_X + SPAWN_MARGIN); enemy_y[i] = spawn_y_table[rand8()]; enemy_dx[i] = -1; break;
+    }
+    if (enemy_type[i] == ENEMY_BOUNCER) { // Diagonal
+        if (enemy_dx[i] == 0) enemy_dx[i] = (r & 0x20) ? 1 : -1; else enemy_dy[i] = (r & 0x20) ? 1 : -1;
+    }
+    grid_insert(i);
+}
 
-    // Declare draw_player here, OUTSIDE the main loop.
-    // We will just set its value inside the loop.
-    // THIS IS A CHANGE from the previous attempt.
-    unsigned char draw_player;
+// --- Enemy Behaviours ---
+// One handler per ENEMY_* type, run for enemy_slot on each of its AI updates (every
+// ai_slices frames), so each moves enemy_step pixels a call to keep its speed per frame.
+typedef void (*enemy_behaviour_fn)(void);
+
+void enemy_homing(void) { // Towards the player on both axes, without overshooting
+    unsigned char e;
+    e = enemy_y[enemy_slot];
+    if (e < player_y) e = (player_y - e > enemy_step) ? e + enemy_step : player_y;
+    else if (e > player_y) e = (e - player_y > enemy_step) ? e - enemy_step : player_y;
+    enemy_y[enemy_slot] = e;
+    e = enemy_x[enemy_slot];
+    if (e < player_x) e = (player_x - e > enemy_step) ? e + enemy_step : player_x;
+    else if (e > player_x) e = (e - player_x > enemy_step) ? e - enemy_step : player_x;
+    enemy_x[enemy_slot] = e;
+}
+void enemy_advance(void) { // Along enemy_dx/dy (ENEMY_STRAIGHT); coordinates wrap round at 256
+    if (enemy_dx[enemy_slot] > 0) enemy_x[enemy_slot] += enemy_step; else if (enemy_dx[enemy_slot] < 0) enemy_x[enemy_slot] -= enemy_step;
+    if (enemy_dy[enemy_slot] > 0) enemy_y[enemy_slot] += enemy_step; else if (enemy_dy[enemy_slot] < 0) enemy_y[enemy_slot] -= enemy_step;
+}
+void enemy_sine(void) { // Advances, then moves sideways by the change in the wave offset
+    unsigned char p = enemy_phase[enemy_slot], q = (p + ai_slices) & (ENEMY_WAVE_PERIOD - 1);
+    signed char d = enemy_wave_offset[q] - enemy_wave_offset[p];
+    enemy_phase[enemy_slot] = q;
+    enemy_advance();
+    if (enemy_dx[enemy_slot] != 0) enemy_y[enemy_slot] += d; else enemy_x[enemy_slot] += d;
+}
+void enemy_bouncer(void) { // Turns back inwards once past an edge of the play area
+    if (enemy_x[enemy_slot] < MIN_X) enemy_dx[enemy_slot] = 1; else if (enemy_x[enemy_slot] > MAX_X) enemy_dx[enemy_slot] = -1;
+    if (enemy_y[enemy_slot] < MIN_Y) enemy_dy[enemy_slot] = 1; else if (enemy_y[enemy_slot] > MAX_Y) enemy_dy[enemy_slot] = -1;
+    enemy_advance();
+}
+const enemy_behaviour_fn enemy_behaviour[ENEMY_TYPES] = { enemy_homing, enemy_advance, enemy_sine, enemy_bouncer };
+
+// --- OAM Writer ---
+// Sprites are packed from slot 1 upwards every frame (slot 0 is the split sprite).
+// Instead of clearing the whole page with memset (bench kernel oam_clear), oam_finish()
+// hides only the slots that were used when this page was last built but not now (a Y
+// write each); every other slot is rewritten or already hidden.
+// oam_idx wraps to 0 once all 64 slots are used, so callers check OAM_FULL().
+// oam_publish() hands the page to the NMI and switches oam_buffer to the other page.
+#define OAM_PUT_SPRITE(y, tile, attr, x) do { \
+    oam_buffer[oam_idx + 0] = (y) - 1; oam_buffer[oam_idx + 1] = (tile); \
+    oam_buffer[oam_idx + 2] = (attr); oam_buffer[oam_idx + 3] = (x); oam_idx += 4; } while (0)
+#define OAM_SKIP_SPRITE() do { oam_buffer[oam_idx] = HIDE_SPRITE_Y; oam_idx += 4; } while (0) // Keep slot, hidden
+#define OAM_FULL() (oam_idx == 0) // Wrapped past LAST_VALID_OAM_INDEX
+// Emission kernel: list positions [from, to) of pool p, while OAM has room, skipping
+// entities off the visible lines. tile and attr may use i, the slot being drawn.
+#define OAM_PUT_POOL(p, from, to, tile, attr) \
+    for (n = (from); n < (to); ++n) { \
+        if (OAM_FULL()) break; \
+        i = p##_list[n]; \
+        if (p##_y[i] >= 1 && p##_y[i] < HIDE_SPRITE_Y) OAM_PUT_SPRITE(p##_y[i], (tile), (attr), p##_x[i]); \
+    }
 
+void oam_begin(void) {
+    oam_idx = PLAYER_OAM_OFFSET;
+}
+void oam_finish(void) {
+    unsigned char i = oam_idx, prev_end = oam_prev_end[oam_back_page & 1];
+    // Offsets 4..252 and 0 (= 256, page full) compare in order once 4 is subtracted.
+    if ((unsigned char)(i - 4) < (unsigned char)(prev_end - 4)) {
+        do { oam_buffer[i] = HIDE_SPRITE_Y; i += 4; } while (i != prev_end);
+    }
+    oam_prev_end[oam_back_page & 1] = oam_idx;
+}
+void oam_publish(void) {
+    oam_ready = oam_back_page; // The NMI never shows the page being built next
+    oam_back_page ^= (OAM_PAGE_A ^ OAM_PAGE_B);
+    oam_buffer = OAM_PAGE_PTR(oam_back_page);
+}
 
-    // --- Initial Setup ---
-    PPU.control = 0x00; PPU.mask = 0x00; // PPU Off
-    waitvsync();
-    ppu_set_address(PALETTE_RAM); for (i = 0; i < 32; ++i) ppu_write_data(palette[i]); // Load palettes
-    ppu_set_address(NAMETABLE_A); for (vram_addr = 0; vram_addr < 960; ++vram_addr) ppu_write_data(0x00); // Clear nametable
-    ppu_set_address(ATTRIBUTE_A); for (i = 0; i < 64; ++i) ppu_write_data(0x00); // Clear attributes
-    set_tile_palette(SCORE_TEXT_X, SCORE_TEXT_Y, SCORE_TEXT_PALETTE_IDX, 6 + SCORE_MAX_DIGITS); // Set score palette
-    vram_addr = NAMETABLE_A + (SCORE_TEXT_Y * 32) + SCORE_TEXT_X; // Write "SCORE "
-    ppu_set_address(vram_addr);
-    ppu_write_data('S'-'A'+0x41); ppu_write_data('C'-'A'+0x41); ppu_write_data('O'-'A'+0x41);
-    ppu_write_data('R'-'A'+0x41); ppu_write_data('E'-'A'+0x41); ppu_write_data(0x00);
-
-    memset(oam_buffer, HIDE_SPRITE_Y, 256); // Clear OAM buffer in RAM
+// --- Sprite Multiplexer ---
+// Emits live enemies and projectiles through the OAM writer, after the split sprite
+// (slot 0) and the player (slots 1-4).
+// The draw order is enemy_list followed by projectile_list, read circularly from object
+// mux_start, which moves MUX_ROTATE_STEP objects on each frame, modulo the live count.
+// Each pool is emitted as whole list ranges, so the inner loops never test which pool
+// an object belongs to; the pool holding mux_start is split round the others.
+#define MUX_ENEMIES(from, to) \
+    OAM_PUT_POOL(enemy, from, to, enemy_type_tile[enemy_type[i]], enemy_type_attr[enemy_type[i]])
+#define MUX_PROJECTILES(from, to) \
+    OAM_PUT_POOL(projectile, from, to, PROJECTILE_SPRITE_TILE, (PROJECTILE_SPRITE_PALETTE & 0x03))
+void mux_write_sprites(void) {
+    unsigned char n, i, k, total = enemy_count + projectile_count;
+    if (total == 0) return;
+    while (mux_start >= total) mux_start -= total; // Live count may have dropped
+    k = mux_start;
+    if (k < enemy_count) {
+        MUX_ENEMIES(k, enemy_count);
+        MUX_PROJECTILES(0, projectile_count);
+        MUX_ENEMIES(0, k);
+    } else {
+        k -= enemy_count;
+        MUX_PROJECTILES(k, projectile_count);
+        MUX_ENEMIES(0, enemy_count);
+        MUX_PROJECTILES(0, k);
+    }
+    if (lag_level < LAG_SHED_MUX) mux_start += MUX_ROTATE_STEP;
+}
 
-    // Init Player
-    player_x = 128; player_y = 112; player_health = PLAYER_MAX_HEALTH; player_hit_timer = 0;
-    // Init Enemies
-    for (i = 0; i < MAX_ENEMIES; ++i) enemies[i].active = 0; active_enemy_count = 0;
-    // Init Projectiles
-    for(i = 0; i < MAX_PROJECTILES; ++i) projectiles[i].active = 0;
-    // Init Game State
-    score = 0; score_changed = 1; frame_count = 0; last_joy_status = 0; random_seed = 123;
+// --- Frame Steps ---
+// One call each per frame from main(), in this order. Kept as functions so the
+// benchmarks (bench/) can time them on their own.
+void update_player(void) { // Invincibility timer, movement, firing (input_update() first)
+    if (player_hit_timer > 0) player_hit_timer--; // Update invincibility timer
+
+    // Player Movement
+    if ((pad_held[0] & JOY_UP_MASK) && player_y > MIN_Y) player_y--;
+    if ((pad_held[0] & JOY_DOWN_MASK) && player_y < MAX_Y) player_y++;
+    if ((pad_held[0] & JOY_LEFT_MASK) && player_x > MIN_X) player_x--;
+    if ((pad_held[0] & JOY_RIGHT_MASK) && player_x < MAX_X) player_x++;
+    if (pad_held[0] & JOY_LEFT_MASK) player_facing_left = 1; // Last direction pushed
+    else if (pad_held[0] & JOY_RIGHT_MASK) player_facing_left = 0;
+
+    // Player Firing (Button A, once per press)
+    if (pad_pressed[0] & FIRE_BUTTON_MASK) {
+        slot = projectile_alloc();
+        if (slot != NO_SLOT) {
+            projectile_x[slot] = player_x; projectile_y[slot] = player_y;
+            sound_sfx(sfx_shot);
+        }
+    }
+}
 
-    // --- Turn Rendering On ---
-    waitvsync();
-    PPU.scroll = 0x00; PPU.scroll = 0x00; // Reset scroll
-    PPU.mask = 0x1E;    // BG ON, Sprites ON, Left Columns ON
-    PPU.control = 0x90; // NMI ON, Sprites $0000, BG $1000 (Use 0x80 if BG is $0000)
+unsigned char projectile_step(void) { // The projectile at pos/slot; 0 once it is killed
+    // 1. Move
+    if (projectile_y[slot] > (MIN_Y + PROJECTILE_SPEED)) {
+        projectile_y[slot] -= PROJECTILE_SPEED;
+    } else {
+        projectile_kill(pos); // Off screen
+        return 0;
+    }
 
-    // --- Main Game Loop ---
-    while (1) {
-        waitvsync(); // Wait for VBlank
+    // 2. Collide with Enemies (nearby grid cells only)
+    box_x = projectile_x[slot]; box_y = projectile_y[slot];
+    box_w = PROJECTILE_SPRITE_WIDTH; box_h = PROJECTILE_SPRITE_HEIGHT;
+    hit = grid_find_hit();
+    if (hit == NO_SLOT) return 1;
+    enemy_kill(enemy_list_pos[hit]); // Deactivate enemy
+    add_score(0x01);
+    sound_sfx(sfx_kill);
+    projectile_kill(pos); // Deactivate projectile
+    return 0;
+}
+void update_projectiles(void) {
+    // Walks live projectiles only; a kill moves the last list entry into position pos.
+    POOL_UPDATE(projectile, pos, slot, projectile_step());
+}
+
+void update_enemies(void) { // Spawning, movement, player collision
+    frame_count++; // Spawning Timer
+    if ((frame_count >= (lag_level >= LAG_SHED_SPAWN ? SPAWN_INTERVAL * 2 : SPAWN_INTERVAL)) &&
+        (enemy_count < MAX_ENEMIES)) {
+         spawn_enemy(); frame_count = 0;
+    }
 
-        // --- PPU Updates (during VBlank) ---
-        trigger_oam_dma(); // Send OAM data from LAST frame
-        if (score_changed) { update_score_display(); score_changed = 0; } // Update score if needed
+    // Enemy Movement (this frame's AI group only, see AI_SLICES). A kill swaps the last
+    // list entry into the freed position, so that enemy may move a round early or late.
+    // Each step is an indexed jump on the type byte (Enemy Behaviours), then a grid_move()
+    // to keep the broad phase in step.
+    POOL_UPDATE_SLICE(enemy, enemy_pos, enemy_slot, enemy_ai_phase, ai_slices,
+                      (enemy_behaviour[enemy_type[enemy_slot]](), grid_move(enemy_slot)));
+    if (++enemy_ai_phase == ai_slices) enemy_ai_phase = 0;
+
+    // Player Collision (only if player not invincible, nearby grid cells only)
+    if (player_hit_timer == 0) {
+        box_x = player_x; box_y = player_y; box_w = PLAYER_SPRITE_WIDTH; box_h = PLAYER_SPRITE_HEIGHT;
+        hit = grid_find_hit();
+        if (hit != NO_SLOT) {
+            player_health--; player_hit_timer = PLAYER_INVINCIBILITY_FRAMES;
+            sound_sfx(sfx_hit);
+            // Keep enemy active after hitting player? Or deactivate?
+            // enemy_kill(enemy_list_pos[hit]); // Uncomment to kill enemy on touch
+            // At 0 health main() ends the game once this frame is done
+        }
+    } // End if player not invincible
+}
 
-        // --- Prepare OAM Buffer for NEXT frame ---
-        memset(oam_buffer, HIDE_SPRITE_Y, 256); // Clear RAM buffer first
-        oam_idx = PLAYER_OAM_OFFSET; // Reset OAM index for this frame
+void build_oam(void) { // Fills and publishes the back OAM page
+    unsigned char draw_player, i;
 
+    oam_begin(); // Reset OAM index for this frame (no clear, see oam_finish)
 
-        // !!! CRITICAL DRAW_PLAYER SECTION !!!
-        // Check syntax immediately before and after this block carefully.
 
-        // Set default value for draw_player for this frame.
-        // draw_player was declared OUTSIDE the loop this time.
-        draw_player = 1;
+    // !!! CRITICAL DRAW_PLAYER SECTION !!!
+    // Check syntax immediately before and after this block carefully.
 
-        // Check if player is invincible and should flash (be hidden)
-        if (player_hit_timer > 0) {
-            if ((player_hit_timer % 8) < 4) { // Hidden part of the flash cycle
-                 draw_player = 0; // Set flag to NOT draw player this frame
-            }
-        }
+    // Set default value for draw_player for this frame.
+    draw_player = 1;
 
-        // Now, USE the draw_player flag to decide OAM write
-        // Ensure the line above this has a correct ending (like ';')
-        // Line 392 was pointing around here.
-        if (draw_player && player_y >= 1 && player_y < HIDE_SPRITE_Y) {
-            oam_buffer[oam_idx + 0] = player_y - 1;
-            oam_buffer[oam_idx + 1] = PLAYER_SPRITE_TILE;
-            oam_buffer[oam_idx + 2] = (PLAYER_SPRITE_PALETTE & 0x03);
-            oam_buffer[oam_idx + 3] = player_x;
-        }
-        // Ensure the line below this starts correctly.
-        oam_idx += 4; // Always advance index past player sprite slot
-
-        // !!! END OF CRITICAL SECTION !!!
-
-
-        // Write Active Enemies to OAM
-        for (i = 0; i < MAX_ENEMIES; ++i) {
-            if (enemies[i].active) {
-                 if (oam_idx <= LAST_VALID_OAM_INDEX) {
-                    if(enemies[i].y >= 1 && enemies[i].y < HIDE_SPRITE_Y) {
-                         oam_buffer[oam_idx + 0] = enemies[i].y - 1;
-                         oam_buffer[oam_idx + 1] = ENEMY_SPRITE_TILE;
-                         oam_buffer[oam_idx + 2] = (ENEMY_SPRITE_PALETTE & 0x03);
-                         oam_buffer[oam_idx + 3] = enemies[i].x;
-                         oam_idx += 4;
-                    }
-                 } else { break; } // OAM full
-            }
+    // Check if player is invincible and should flash (be hidden)
+    if (player_hit_timer > 0) {
+        if ((player_hit_timer % 8) < 4) { // Hidden part of the flash cycle
+             draw_player = 0; // Set flag to NOT draw player this frame
         }
+    }
 
-        // Write Active Projectiles to OAM
-        for (i = 0; i < MAX_PROJECTILES; ++i) {
-            if (projectiles[i].active) {
-                if (oam_idx <= LAST_VALID_OAM_INDEX) {
-                    if(projectiles[i].y >= 1 && projectiles[i].y < HIDE_SPRITE_Y) {
-                         oam_buffer[oam_idx + 0] = projectiles[i].y - 1;
-                         oam_buffer[oam_idx + 1] = PROJECTILE_SPRITE_TILE;
-                         oam_buffer[oam_idx + 2] = (PROJECTILE_SPRITE_PALETTE & 0x03);
-                         oam_buffer[oam_idx + 3] = projectiles[i].x;
-                         oam_idx += 4;
-                    }
-                } else { break; } // OAM full
-            }
+    // Now, USE the draw_player flag to decide OAM write
+    // Ensure the line above this has a correct ending (like ';')
+    // Line 392 was pointing around here.
+    // player_x/y stay within MIN/MAX_X/Y, so no piece is ever clipped and the player
+    // always fills its PLAYER_SPRITES slots.
+    if (draw_player) {
+        if (player_facing_left) oam_meta_flip(player_x - PLAYER_META_OFFSET, player_y - PLAYER_META_OFFSET, player_meta);
+        else oam_meta(player_x - PLAYER_META_OFFSET, player_y - PLAYER_META_OFFSET, player_meta);
+    } else {
+        for (i = 0; i < PLAYER_SPRITES; ++i) {
+            OAM_SKIP_SPRITE(); // Always advance index past the player's slots
         }
+    }
+
+    // !!! END OF CRITICAL SECTION !!!
 
-        // --- Game Logic ---
-        if (player_hit_timer > 0) player_hit_timer--; // Update invincibility timer
-
-        joy_status = read_joypad1(); // Read input
-
-        // Player Movement
-        if ((joy_status & JOY_UP_MASK) && player_y > MIN_Y) player_y--;
-        if ((joy_status & JOY_DOWN_MASK) && player_y < MAX_Y) player_y++;
-        if ((joy_status & JOY_LEFT_MASK) && player_x > MIN_X) player_x--;
-        if ((joy_status & JOY_RIGHT_MASK) && player_x < MAX_X) player_x++;
-
-        // Player Firing (Button A - 0x80)
-        if ((joy_status & FIRE_BUTTON_MASK) && !(last_joy_status & FIRE_BUTTON_MASK)) {
-            for (i = 0; i < MAX_PROJECTILES; ++i) {
-                if (!projectiles[i].active) {
-                    projectiles[i].active = 1;
-                    projectiles[i].x = player_x; projectiles[i].y = player_y;
-                    break;
-                }
-            }
-        }
-        last_joy_status = joy_status; // Store for next frame
-
-        // --- Projectile Logic ---
-        for (i = 0; i < MAX_PROJECTILES; ++i) {
-            if (projectiles[i].active) {
-                // 1. Move
-                if (projectiles[i].y > (MIN_Y + PROJECTILE_SPEED)) {
-                    projectiles[i].y -= PROJECTILE_SPEED;
-                } else {
-                    projectiles[i].active = 0;
-                    continue; // Off screen, go to next projectile
-                }
-
-                // 2. Collide with Enemies
-                for (j = 0; j < MAX_ENEMIES; ++j) {
-                     if (enemies[j].active) {
-                         if (check_collision(projectiles[i].x, projectiles[i].y, PROJECTILE_SPRITE_WIDTH, PROJECTILE_SPRITE_HEIGHT,
-                                             enemies[j].x, enemies[j].y, ENEMY_SPRITE_WIDTH, ENEMY_SPRITE_HEIGHT))
-                         {
-                             projectiles[i].active = 0; // Deactivate projectile
-                             enemies[j].active = 0;     // Deactivate enemy
-                             active_enemy_count--;
-                             score++; score_changed = 1;
-                             // Since projectile is now inactive, break inner loop and outer loop will continue to next i
-                             break; // Stop checking this projectile against other enemies
-                         }
-                     }
-                 } // End enemy loop (j)
-            } // End if projectile active
-        } // End projectile loop (i)
-
-
-        // --- Enemy Logic ---
-        frame_count++; // Spawning Timer
-        if ((frame_count >= SPAWN_INTERVAL) && (active_enemy_count < MAX_ENEMIES)) {
-             spawn_enemy(); frame_count = 0;
-        }
 
-        // Enemy Movement & Player Collision
-        for (i = 0; i < MAX_ENEMIES; ++i) {
-            if (enemies[i].active) {
-                // 1. Move
-                if (enemies[i].y < player_y) enemies[i].y++; else if (enemies[i].y > player_y) enemies[i].y--;
-                if (enemies[i].x < player_x) enemies[i].x++; else if (enemies[i].x > player_x) enemies[i].x--;
-
-                // 2. Collide with Player (only if player not invincible)
-                if (player_hit_timer == 0) {
-                     if (check_collision(player_x, player_y, PLAYER_SPRITE_WIDTH, PLAYER_SPRITE_HEIGHT,
-                                         enemies[i].x, enemies[i].y, ENEMY_SPRITE_WIDTH, ENEMY_SPRITE_HEIGHT))
-                    {
-                        player_health--; player_hit_timer = PLAYER_INVINCIBILITY_FRAMES;
-                        // Keep enemy active after hitting player? Or deactivate?
-                        // enemies[i].active = 0; active_enemy_count--; // Uncomment to kill enemy on touch
-
-                        if (player_health == 0) {
-                            game_over_halt(); // Check for Game Over
-                        }
-                        // Don't check collision with other enemies in same frame if player just got hit
-                        // (This is implicitly handled by the hit timer)
-                    }
-                } // End if player not invincible
-            } // End if enemy active
-        } // End enemy loop (i)
-
-    } // End while(1)
-
-} // End main()
\ No newline at end of file
+    // Write Enemies & Projectiles to OAM (rotating priority, see mux_write_sprites)
+    mux_write_sprites();
+    oam_finish(); // Hide only the slots that fell out of use since this page was last built
+    split_x[oam_back_page & 1] = scroll_x; // The playfield scroll these sprites go with
+    oam_publish(); // NMI DMAs it at the next vblank
+}
+
+// --- Game Setup and Frame ---
+// main() runs game_init() then game_frame() until health runs out; native/sim.c drives
+// them directly.
+void game_init(void) {
+    // --- Initial Setup ---
+    ppu_ctrl(0x00); ppu_mask(0x00); // PPU Off
+    platform_waitvsync();
+    vram_copy(PALETTE_RAM, palette, sizeof(palette)); // Load palettes
+    vram_fill(NAMETABLE_A, 0x00, 2 * 1024); // Clear nametables A and B and their attributes (vram.s)
+    vram_fill(NAMETABLE_A + (HUD_ROWS - 1) * 32, HUD_BAR_TILE, 32); // Status bar's bottom edge
+    playfield_draw();
+    attr_init(0x00); // Status bar rows only: playfield_draw/scroll bypass the shadow
+    attr_set_rect(SCORE_TEXT_X, SCORE_TEXT_Y, 6 + SCORE_DIGITS, 1, SCORE_TEXT_PALETTE_IDX); // Set score palette
+    text_queue(NAMETABLE_A + (SCORE_TEXT_Y * 32) + SCORE_TEXT_X, text_score); // Write "SCORE "
+
+    oam_back_page = OAM_PAGE_A; oam_buffer = OAM_PAGE_PTR(OAM_PAGE_A);
+    memset(oam_buffer, HIDE_SPRITE_Y, 512); // Clear both OAM pages in RAM (once; oam_finish() keeps them tidy)
+    memcpy(OAM_PAGE_PTR(OAM_PAGE_A) + SPLIT_OAM_OFFSET, split_sprite, 4); // Sprite 0 for good
+    memcpy(OAM_PAGE_PTR(OAM_PAGE_B) + SPLIT_OAM_OFFSET, split_sprite, 4);
+    oam_prev_end[0] = oam_prev_end[1] = PLAYER_OAM_OFFSET;
+    split_x[0] = split_x[1] = 0; split_on = 1;
+    oam_ready = OAM_PAGE_B; // Sprite 0 on screen from the first vblank, for the first split
+
+    // Init Player
+    player_x = 128; player_y = 112; player_health = PLAYER_MAX_HEALTH; player_hit_timer = 0;
+    player_facing_left = 0;
+    // Init Enemies & Projectiles (all slots free)
+    entity_lists_init();
+    // Init Game State
+    score_reset(); score_changed = SCORE_DIGITS; frame_count = 0; pad_held[0] = 0; rand_seed = SPAWN_SEED; mux_start = 0;
+    lag_set_level(0); lag_frames = lag_streak = lag_worst_streak = 0;
+    sound_music(song_main);
+
+    // --- Turn Rendering On ---
+    platform_waitvsync();
+    ppu_scroll(0x00, 0x00); // Reset scroll
+    ppu_mask(0x1E);    // BG ON, Sprites ON, Left Columns ON (PROF_MASK_BASE)
+    ppu_ctrl(0x90);    // NMI ON, Sprites $0000, BG $1000 (Use 0x80 if BG is $0000)
+    last_frame = nmi_frame;
+}
+
+void game_frame(void) {
+    // Sprites built last iteration, and their scroll, are on screen from this vblank
+    unsigned char catch_up = lag_update(wait_frame());
+    PROF_FRAME();
+    PROF_BEGIN(PROF_BASELINE); PROF_END();
+
+    PROF_BEGIN(PROF_PLAYER);
+    sound_update(); // APU registers for the NMI: a fixed point in the frame, fixed worst case
+    // --- PPU Updates (drained by the NMI) ---
+    if (score_changed && update_score_display()) score_changed = 0; // Queued for the NMI; retried if full
+    attr_flush(); // Changed attribute bytes, if any
+    playfield_scroll(); // Scroll for the next frame, and the column it needs
+
+    // --- Game Logic ---
+    input_update(); // Read both pads; masks land in zero page
+    update_player();
+    PROF_END();
+
+    PROF_BEGIN(PROF_PROJECTILES);
+    update_projectiles();
+    PROF_END();
+
+    PROF_BEGIN(PROF_ENEMIES);
+    update_enemies();
+    PROF_END();
+
+    // --- Lag Catch-up (see Lag Handling; not profiled) ---
+    if (catch_up > LAG_CATCHUP_MAX) catch_up = LAG_CATCHUP_MAX;
+    pad_pressed[0] = 0; // A press acts once, in the update above
+    for (; catch_up != 0 && player_health != 0; --catch_up) {
+        sound_update(); playfield_scroll(); update_player(); update_projectiles(); update_enemies();
+    }
+
+    // --- Build OAM for the NEXT vblank (after logic, so this frame's input shows at once) ---
+    PROF_BEGIN(PROF_OAM);
+    build_oam();
+    PROF_END();
+}
+
+// --- Main Function ---
+#ifndef SURVIVOR_NO_MAIN // Defined by bench/ and native/, which include this file
+// Full screens (screen.h) replace the whole nametable with rendering off: one RLE
+// stream decoded straight into the PPU, which takes a frame or two, with no queueing.
+void screen_load(const unsigned char* screen) {
+    ppu_ctrl(0x00); ppu_mask(0x00); // PPU Off
+    split_on = 0; // Screens don't scroll, and have no sprite 0
+    platform_waitvsync();
+    vram_queue_head = vram_queue_tail; // Drop updates meant for the previous screen
+    vram_copy(PALETTE_RAM, palette, sizeof(palette));
+    vram_unrle(NAMETABLE_A, screen);
+}
+
+void screen_on(void) { // After any extra vram_* writes to the loaded screen
+    platform_waitvsync();
+    ppu_scroll(0x00, 0x00);
+    ppu_mask(0x0A);    // BG ON, Left Column ON; sprites stay off over a screen
+    ppu_ctrl(0x90);    // NMI ON, as in game_init()
+    last_frame = nmi_frame;
+}
+
+void screen_wait_start(void) {
+    do {
+        wait_frame();
+        sound_update();
+        input_update();
+    } while (!(pad_pressed[0] & JOY_START_MASK));
+}
+
+void main(void) {
+    unsigned char tiles[SCORE_DIGITS];
+    pad_held[0] = 0; // Zero page isn't cleared at startup (input.h)
+    sound_init();
+    screen_load(screen_title);
+    screen_on();
+    screen_wait_start();
+    while (1) {
+        game_init();
+        while (player_health) {
+            game_frame();
+        }
+        sound_music(NULL); // The hit effect plays out over the game-over screen
+        screen_load(screen_game_over);
+        score_digit_tiles(tiles, SCORE_DIGITS); // Final score after the layout's "SCORE "
+        vram_copy(NAMETABLE_A + SCREEN_SCORE_Y * 32 + SCREEN_SCORE_X, tiles, SCORE_DIGITS);
+        screen_on();
+        screen_wait_start();
+    }
+} // End main()
+#endif
\ No newline at end of file
@@ -0,0 +1,20 @@
+#include "text.h"
+
+#pragma static-locals (on)
+
+// --- Number Formatting (see text.h) ---
+// Digits come from repeated subtraction, at most 9 per power of ten, instead of cc65's
+// 16-bit division routine.
+static const unsigned int text_pow10[5] = { 10000, 1000, 100, 10, 1 };
+
+void text_number(unsigned char* tiles, unsigned int value, unsigned char width) {
+    unsigned char digits[5], i, d, blank = 1;
+    for (i = 0; i < 5; ++i) {
+        for (d = 0; value >= text_pow10[i]; ++d) value -= text_pow10[i];
+        digits[i] = d;
+    }
+    for (i = 5 - width; i < 5; ++i) {
+        if (digits[i] != 0 || i == 4) blank = 0;
+        *tiles++ = blank ? TEXT_TILE_BLANK : TEXT_TILE_ZERO + digits[i];
+    }
+}
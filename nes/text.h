@@ -0,0 +1,24 @@
+#ifndef TEXT_H
+#define TEXT_H
+
+// --- Text ---
+// Fixed strings are converted to tile indices when text.s is assembled and stored in ROM
+// length-prefixed ([len] [tiles...]), so drawing one is a single bulk VRAM run with no
+// per-character work. Numbers are formatted into tiles by text_number() (text.c).
+#define TEXT_TILE_ZERO  0x30 // Digit tiles $30..$39
+#define TEXT_TILE_BLANK 0x00 // Space (keep in sync with text.s)
+
+extern const unsigned char text_score[]; // "SCORE "
+extern const unsigned char text_hello[]; // "HELLO NES!"
+
+#define TEXT_LEN(s)            ((s)[0])
+// Writes s at addr straight away (rendering off, see vram.h).
+#define text_draw(addr, s)     vram_copy((addr), (s) + 1, (s)[0])
+// Queues s for the next vblank (vram_queue.h); 0 if the queue is full.
+#define text_queue(addr, s)    vram_queue_put((addr), (s) + 1, (s)[0])
+
+// Writes value right-aligned into tiles[0..width-1] (width 1..5), leading zeros blank.
+// Digits above the width are dropped.
+void text_number(unsigned char* tiles, unsigned int value, unsigned char width);
+
+#endif
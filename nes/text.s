@@ -0,0 +1,19 @@
+;
+; text.s - the programs' fixed strings, turned into tile indices at assembly time.
+;
+; charmap.inc maps source characters onto the font in CHR (letters and digits keep
+; their ASCII codes, space is the blank tile). Each string is stored length-prefixed,
+; [len] [tiles...], ready for text_draw()/text_queue() in text.h.
+;
+
+        .include        "charmap.inc"
+        .export         _text_score, _text_hello
+
+.macro  string  name, str
+name:   .byte   .strlen(str), str
+.endmacro
+
+.segment        "RODATA"
+
+        string  _text_score, "SCORE "
+        string  _text_hello, "HELLO NES!"
@@ -0,0 +1,30 @@
+#ifndef VRAM_H
+#define VRAM_H
+
+// --- Bulk VRAM Transfers (vram.s) ---
+// Each call sets the PPU address itself and streams its bytes to PPU.vram.data from an
+// unrolled loop, so only use them while rendering is off or inside vblank; small updates
+// during play belong in the VRAM queue (vram_queue.h). The NMI in nmi.s touches the PPU
+// address too, so run big transfers with NMIs off, as the programs' setup code does.
+// All of them use cc65's default (fastcall) convention: last argument in A/X.
+
+// PPU.control as last written through ppu_ctrl() (platform.h). vram_copy_stride32()
+// switches to +32 increments and writes this back when done.
+extern unsigned char vram_ctrl;
+
+// Writes value to len bytes from addr.
+void vram_fill(unsigned int addr, unsigned char value, unsigned int len);
+
+// Copies len bytes from src (ROM or RAM) to addr.
+void vram_copy(unsigned int addr, const unsigned char* src, unsigned int len);
+
+// Copies len bytes from src down a nametable column (+32 per byte) from addr.
+void vram_copy_stride32(unsigned int addr, const unsigned char* src, unsigned char len);
+
+// Decodes an RLE stream to addr. The stream is a list of tokens:
+//   0x01..0x7F  that many literal bytes follow
+//   0x81..0xFF  the next byte repeated (token & 0x7F) times
+//   0x00        end of stream
+void vram_unrle(unsigned int addr, const unsigned char* src);
+
+#endif
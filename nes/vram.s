@@ -0,0 +1,190 @@
+;
+; vram.s - bulk VRAM transfers for screen setup (see vram.h).
+;
+; Replaces per-byte C calls with unrolled store loops: a fill costs 4 cycles a byte
+; plus loop overhead every 8 bytes, a copy 11. Nothing here waits for vblank; the
+; caller has rendering off or is inside vblank already.
+;
+
+        .include        "zeropage.inc"
+        .import         popa, popax
+        .export         _vram_fill, _vram_copy, _vram_copy_stride32, _vram_unrle
+        .export         _vram_ctrl
+
+PPU_CTRL          = $2000
+PPU_STATUS        = $2002
+PPU_VRAM_ADDR2    = $2006
+PPU_VRAM_IO       = $2007
+
+CTRL_INC32        = $04                 ; PPU.control: +32 after each data access
+
+.segment        "BSS"
+
+_vram_ctrl:       .res    1             ; Shadow of PPU.control (platform.h ppu_ctrl)
+
+.segment        "CODE"
+
+; ------------------------------------------------------------------------
+; Point the PPU at A (low) / X (high). Leaves A and X alone.
+
+set_addr:
+        bit     PPU_STATUS              ; Reset the address latch
+        stx     PPU_VRAM_ADDR2
+        sta     PPU_VRAM_ADDR2
+        rts
+
+; ------------------------------------------------------------------------
+; void vram_fill(unsigned int addr, unsigned char value, unsigned int len)
+
+_vram_fill:
+        sta     tmp1                    ; len low
+        stx     tmp2                    ; len high: whole pages
+        jsr     popa
+        sta     tmp3                    ; value
+        jsr     popax
+        jsr     set_addr
+        lda     tmp1
+        lsr
+        lsr
+        lsr
+        sta     tmp4                    ; 8-byte blocks in len low
+        lda     tmp1
+        and     #7
+        tay                             ; Odd bytes
+        lda     tmp3
+        cpy     #0
+        beq     @blocks
+@odd:   sta     PPU_VRAM_IO
+        dey
+        bne     @odd
+@blocks:ldx     tmp4
+        beq     @pages
+@block: .repeat 8
+        sta     PPU_VRAM_IO
+        .endrepeat
+        dex
+        bne     @block
+@pages: ldx     tmp2
+        beq     @done
+@page:  ldy     #256 / 8
+@pblock:.repeat 8
+        sta     PPU_VRAM_IO
+        .endrepeat
+        dey
+        bne     @pblock
+        dex
+        bne     @page
+@done:  rts
+
+; ------------------------------------------------------------------------
+; void vram_copy(unsigned int addr, const unsigned char* src, unsigned int len)
+
+_vram_copy:
+        sta     tmp1                    ; len low
+        stx     tmp2                    ; len high: whole pages
+        jsr     popax
+        sta     ptr1
+        stx     ptr1+1
+        jsr     popax
+        jsr     set_addr
+        ldy     #0
+        ldx     tmp2
+        beq     @tail
+@page:  .repeat 8                       ; 32 passes: Y wraps to 0 after 256 bytes
+        lda     (ptr1),y
+        sta     PPU_VRAM_IO
+        iny
+        .endrepeat
+        bne     @page
+        inc     ptr1+1
+        dex
+        bne     @page
+@tail:  lda     tmp1                    ; Y = 0 here, and stays below 256 from now on
+        lsr
+        lsr
+        lsr
+        beq     @odd
+        tax                             ; 8-byte blocks
+@block: .repeat 8
+        lda     (ptr1),y
+        sta     PPU_VRAM_IO
+        iny
+        .endrepeat
+        dex
+        bne     @block
+@odd:   lda     tmp1
+        and     #7
+        beq     @done
+        tax
+@byte:  lda     (ptr1),y
+        sta     PPU_VRAM_IO
+        iny
+        dex
+        bne     @byte
+@done:  rts
+
+; ------------------------------------------------------------------------
+; void vram_copy_stride32(unsigned int addr, const unsigned char* src, unsigned char len)
+; Switches PPU.control to +32 increments for the copy, then restores vram_ctrl.
+
+_vram_copy_stride32:
+        sta     tmp1                    ; len
+        jsr     popax
+        sta     ptr1
+        stx     ptr1+1
+        jsr     popax
+        tay                             ; addr low
+        lda     _vram_ctrl
+        ora     #CTRL_INC32
+        sta     PPU_CTRL
+        tya
+        jsr     set_addr
+        ldy     #0
+        ldx     tmp1
+        beq     @done
+@byte:  lda     (ptr1),y
+        sta     PPU_VRAM_IO
+        iny
+        dex
+        bne     @byte
+@done:  lda     _vram_ctrl              ; Back to the caller's increment
+        sta     PPU_CTRL
+        rts
+
+; ------------------------------------------------------------------------
+; void vram_unrle(unsigned int addr, const unsigned char* src)
+; ptr1 is advanced past each token once it has been sent.
+
+_vram_unrle:
+        sta     ptr1
+        stx     ptr1+1
+        jsr     popax
+        jsr     set_addr
+@token: ldy     #0
+        lda     (ptr1),y
+        beq     @done                   ; End of stream
+        bmi     @run
+        tax                             ; Literal: X bytes follow
+@lit:   iny
+        lda     (ptr1),y
+        sta     PPU_VRAM_IO
+        dex
+        bne     @lit
+        iny                             ; Token + literals consumed
+        bne     @next                   ; Always taken (Y <= 128)
+@run:   and     #$7F
+        tax                             ; Run: X copies of the next byte
+        iny
+        lda     (ptr1),y
+@rep:   sta     PPU_VRAM_IO
+        dex
+        bne     @rep
+        ldy     #2                      ; Token + value consumed
+@next:  tya
+        clc
+        adc     ptr1
+        sta     ptr1
+        bcc     @token
+        inc     ptr1+1
+        jmp     @token
+@done:  rts
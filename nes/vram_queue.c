@@ -0,0 +1,15 @@
+#include "vram_queue.h"
+
+// --- VRAM Update Queue (producer side, see nmi.s for the drain) ---
+unsigned char vram_queue_put(unsigned int addr, const unsigned char* data, unsigned char len) {
+    unsigned char i, head;
+    if (len == 0 || len > VRAM_QUEUE_BUDGET) return 0;
+    if ((unsigned char)(vram_queue_tail - vram_queue_head - 1) < len + 3) return 0; // Ring full
+    head = vram_queue_head;
+    vram_queue[head++] = len;
+    vram_queue[head++] = (unsigned char)(addr >> 8);
+    vram_queue[head++] = (unsigned char)(addr & 0xFF);
+    for (i = 0; i < len; ++i) vram_queue[head++] = data[i];
+    vram_queue_head = head; // Publish last so the NMI never sees a half-written run
+    return 1;
+}
@@ -0,0 +1,23 @@
+#ifndef VRAM_QUEUE_H
+#define VRAM_QUEUE_H
+
+// --- VRAM Update Queue ---
+// Game code appends runs of bytes (address + data) at any time; the NMI handler in
+// nmi.s drains whole runs in vblank until VRAM_QUEUE_BUDGET bytes have been sent and
+// leaves the rest for the next frame. Entry layout in the 256-byte ring:
+//   [len] [addr hi] [addr lo] [len data bytes]
+// A run queued with VRAM_QUEUE_COLUMN in its address goes down a nametable column (+32
+// per byte). The NMI sets PPU.control from vram_ctrl (vram.h) for those, so programs that
+// queue column runs write PPU.control through ppu_ctrl() (platform.h).
+#define VRAM_QUEUE_BUDGET 64     // Data bytes per vblank (keep in sync with nmi.s); also the longest run
+#define VRAM_QUEUE_COLUMN 0x8000 // OR into a run's address: write it down a column
+
+extern unsigned char vram_queue[256];
+extern unsigned char vram_queue_head;          // Next free byte (written by game code only)
+extern volatile unsigned char vram_queue_tail; // Next byte to drain (written by the NMI only)
+
+// Queues len (1..VRAM_QUEUE_BUDGET) bytes for PPU address addr.
+// Returns 0 without queueing anything if the ring is too full; retry next frame.
+unsigned char vram_queue_put(unsigned int addr, const unsigned char* data, unsigned char len);
+
+#endif
@@ -0,0 +1,23 @@
+#!/bin/sh
+# zp_report.sh MAPFILE [ZP_BYTES]
+# Lists the symbols ld65 placed in zero page (from the map's "Exports list by value")
+# and how many bytes of the ZP area are still free. ZP_BYTES defaults to survivor.cfg's
+# ZP size ($60). Only exported symbols show up, so keep hot variables non-static.
+map=$1
+size=${2:-96}
+awk -v size="$size" -v map="$map" '
+function hex(s,    i, n) {
+    n = 0; s = toupper(s)
+    for (i = 1; i <= length(s); i++) n = n * 16 + index("0123456789ABCDEF", substr(s, i, 1)) - 1
+    return n
+}
+/^Segment list:/            { in_segs = 1; next }
+in_segs && $1 == "ZEROPAGE" { used = hex($4); in_segs = 0 }
+/^Exports list by value:/   { in_exports = 1; print "Zero page symbols (" map "):"; next }
+/^Imports list:/            { in_exports = 0 }
+in_exports {
+    for (i = 1; i + 2 <= NF; i += 3)
+        if ($(i + 2) ~ /Z/) printf "  $%s  %s\n", substr($(i + 1), 5), $i
+}
+END { printf "Zero page: %d of %d bytes used, %d free\n", used, size, size - used }
+' "$map"